@@ -0,0 +1,239 @@
+/*
+  Parallel parameter sweep over an ns-3 program.
+
+  Every combination of the --grid values is one job. Jobs run as separate
+  processes, --jobs at a time, each in its own directory under --out with
+  its stdout in stdout.txt. When all jobs are done the metrics found in
+  each stdout are collected into one table, printed and saved as
+  <out>/sweep.csv.
+
+  A metric is "name=text": the numbers following every occurrence of text
+  in the job's stdout, summed. The defaults match First:
+    drops=No of packet drop:
+    goodput=goodput:              (sum over the flows, Mbps)
+
+  Run through waf so the ns-3 libraries are found by the jobs:
+  ./waf --run "scratch/Sweep --program=build/scratch/First --out=sweep
+               --grid=tcp=TcpNewReno,TcpNewRenoPlus --grid=errorRate=0,0.00001
+               --grid=RngRun=1,2,3,4"
+*/
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace std;
+
+struct GridParam{
+    string name;
+    vector<string> values;
+};
+
+struct Metric{
+    string name;
+    string text;
+};
+
+struct Job{
+    vector<string> values;      // one per grid parameter
+    string dir;
+    int status;
+    vector<double> metrics;
+};
+
+static vector<string> SplitList (string list, char sep){
+    vector<string> items;
+    stringstream ss (list);
+    string item;
+    while (getline (ss, item, sep)){
+        items.push_back (item);
+    }
+    return items;
+}
+
+//Runs program with args inside dir, stdout and stderr to dir/stdout.txt; returns the exit status.
+//The child of this multi-threaded process may only make async-signal-safe
+//calls, so its argv is allocated before the fork
+static int RunJob (string program, vector<string> args, string dir){
+    vector<char *> argv;
+    argv.push_back (const_cast<char *> (program.c_str ()));
+    for (string &a : args){
+        argv.push_back (const_cast<char *> (a.c_str ()));
+    }
+    argv.push_back (0);
+    pid_t pid = fork ();
+    if (pid == 0){
+        if (chdir (dir.c_str ()) != 0){
+            _exit (127);
+        }
+        int fd = open ("stdout.txt", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd >= 0){
+            dup2 (fd, STDOUT_FILENO);
+            dup2 (fd, STDERR_FILENO);
+            close (fd);
+        }
+        execv (program.c_str (), argv.data ());
+        _exit (127);
+    }
+    int status = -1;
+    if (pid < 0 || waitpid (pid, &status, 0) < 0){
+        return -1;
+    }
+    return WIFEXITED (status) ? WEXITSTATUS (status) : -1;
+}
+
+static double ReadMetric (string output, string text){
+    double sum = 0;
+    for (size_t pos = output.find (text); pos != string::npos; pos = output.find (text, pos + text.size ())){
+        sum += strtod (output.c_str () + pos + text.size (), 0);
+    }
+    return sum;
+}
+
+int main (int argc, char *argv[]){
+    string program;
+    string out = "sweep";
+    vector<string> fixedArgs;
+    vector<GridParam> grid;
+    vector<Metric> metrics;
+    unsigned jobs = max (thread::hardware_concurrency (), 1u);
+
+    for (int i = 1; i < argc; i++){
+        string arg = argv[i];
+        size_t eq = arg.find ('=');
+        string key = arg.substr (0, eq);
+        string value = eq == string::npos ? "" : arg.substr (eq + 1);
+        if (key == "--program"){
+            program = value;
+        }
+        else if (key == "--out"){
+            out = value;
+        }
+        else if (key == "--jobs"){
+            jobs = max (atoi (value.c_str ()), 1);
+        }
+        else if (key == "--arg"){
+            fixedArgs.push_back (value);
+        }
+        else if (key == "--grid" && value.find ('=') != string::npos){
+            size_t e = value.find ('=');
+            grid.push_back ({value.substr (0, e), SplitList (value.substr (e + 1), ',')});
+        }
+        else if (key == "--metric" && value.find ('=') != string::npos){
+            size_t e = value.find ('=');
+            metrics.push_back ({value.substr (0, e), value.substr (e + 1)});
+        }
+        else{
+            cerr<<"Usage: "<<argv[0]<<" --program=<ns-3 program> [--out=dir] [--jobs=n]"<<endl;
+            cerr<<"       [--grid=name=v1,v2,...]... [--arg=--name=value]... [--metric=name=text]..."<<endl;
+            return 1;
+        }
+    }
+    if (program.empty ()){
+        cerr<<"No --program given"<<endl;
+        return 1;
+    }
+    char resolved[PATH_MAX];
+    if (!realpath (program.c_str (), resolved)){
+        cerr<<"Cannot find "<<program<<endl;
+        return 1;
+    }
+    program = resolved;
+    if (metrics.empty ()){
+        metrics.push_back ({"drops", "No of packet drop:"});
+        metrics.push_back ({"goodput", "goodput:"});
+    }
+
+    //Cartesian product of the grid
+    vector<Job> queue (1);
+    for (const GridParam &p : grid){
+        vector<Job> next;
+        for (const Job &j : queue){
+            for (const string &v : p.values){
+                Job k = j;
+                k.values.push_back (v);
+                next.push_back (k);
+            }
+        }
+        queue.swap (next);
+    }
+
+    mkdir (out.c_str (), 0755);
+    for (size_t i = 0; i < queue.size (); i++){
+        string dir = out + "/job" + to_string (i);
+        for (size_t p = 0; p < grid.size (); p++){
+            dir += "_" + grid[p].name + "-" + queue[i].values[p];
+        }
+        mkdir (dir.c_str (), 0755);
+        queue[i].dir = dir;
+    }
+
+    //Workers take the next job until the queue is empty
+    atomic<size_t> next (0);
+    vector<thread> workers;
+    for (unsigned w = 0; w < min<size_t> (jobs, queue.size ()); w++){
+        workers.push_back (thread ([&] (){
+            for (size_t i = next++; i < queue.size (); i = next++){
+                Job &job = queue[i];
+                vector<string> args = fixedArgs;
+                for (size_t p = 0; p < grid.size (); p++){
+                    args.push_back ("--" + grid[p].name + "=" + job.values[p]);
+                }
+                job.status = RunJob (program, args, job.dir);
+
+                ifstream in (job.dir + "/stdout.txt");
+                stringstream output;
+                output << in.rdbuf ();
+                for (const Metric &m : metrics){
+                    job.metrics.push_back (ReadMetric (output.str (), m.text));
+                }
+            }
+        }));
+    }
+    for (thread &t : workers){
+        t.join ();
+    }
+
+    //Summary table
+    ofstream csv (out + "/sweep.csv");
+    stringstream header;
+    for (const GridParam &p : grid){
+        header << p.name << ",";
+    }
+    for (const Metric &m : metrics){
+        header << m.name << ",";
+    }
+    header << "status,dir";
+    csv << header.str () << "\n";
+    cout << header.str () << "\n";
+    int failed = 0;
+    for (const Job &job : queue){
+        stringstream row;
+        for (const string &v : job.values){
+            row << v << ",";
+        }
+        for (double m : job.metrics){
+            row << m << ",";
+        }
+        row << job.status << "," << job.dir;
+        csv << row.str () << "\n";
+        cout << row.str () << "\n";
+        failed += job.status != 0;
+    }
+    if (failed > 0){
+        cerr<<failed<<" of "<<queue.size ()<<" jobs failed"<<endl;
+    }
+    return failed > 0;
+}
@@ -0,0 +1,182 @@
+#ifndef SIM_PROFILER_H
+#define SIM_PROFILER_H
+
+/*
+  Opt-in wall-clock profiler for the scenario programs (First, RipScenario).
+
+  Records the wall time of each named phase (setup, routing, run,
+  teardown), the events executed by the simulator and their rate during
+  the run phase, the peak RSS, and the time spent inside instrumented
+  trace callbacks. Write () saves all of it as JSON.
+
+  The profiler is per process, like the wall clock and RSS it measures.
+  While it is disabled a callback Scope costs one branch.
+
+    SimProfiler::Enable ();
+    SimProfiler::Phase ("setup");
+    ...
+    static const uint32_t id = SimProfiler::Register ("CwndChange");
+    SimProfiler::Scope scope (id);       // inside the callback
+    ...
+    SimProfiler::Finish ();
+    SimProfiler::Write ("profile.json");
+*/
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+#include "ns3/simulator.h"
+
+class SimProfiler{
+
+        public:
+                typedef std::chrono::steady_clock Clock;
+
+                static void Enable (void);
+                static bool IsEnabled (void);
+
+                //Ends the current phase and starts name; the "run" phase also counts simulator events
+                static void Phase (std::string name);
+                //Ends the current phase
+                static void Finish (void);
+
+                //Returns the id of a named trace callback
+                static uint32_t Register (std::string name);
+
+                //Adds its lifetime to the callback id
+                class Scope{
+                        public:
+                                Scope (uint32_t id);
+                                ~Scope ();
+                        private:
+                                uint32_t        m_id;
+                                Clock::time_point m_start;
+                };
+
+                static void Write (std::string fileName);
+
+        private:
+                struct PhaseRecord{
+                        std::string name;
+                        double seconds;
+                        uint64_t events;
+                };
+                struct CallbackRecord{
+                        std::string name;
+                        uint64_t calls;
+                        Clock::duration time;
+                };
+                struct State{
+                        bool enabled;
+                        std::vector<PhaseRecord> phases;
+                        std::string current;
+                        Clock::time_point phaseStart;
+                        uint64_t phaseEvents;
+                        std::vector<CallbackRecord> callbacks;
+                };
+
+                static State &Get (void);
+};
+
+inline SimProfiler::State &SimProfiler::Get (void){
+        static State state = {false, std::vector<PhaseRecord> (), "", Clock::time_point (), 0, std::vector<CallbackRecord> ()};
+        return state;
+}
+
+inline void SimProfiler::Enable (void){
+        Get ().enabled = true;
+}
+
+inline bool SimProfiler::IsEnabled (void){
+        return Get ().enabled;
+}
+
+inline void SimProfiler::Phase (std::string name){
+        State &s = Get ();
+        if (!s.enabled){
+                return;
+        }
+        Finish ();
+        s.current = name;
+        s.phaseStart = Clock::now ();
+        s.phaseEvents = ns3::Simulator::GetEventCount ();
+}
+
+inline void SimProfiler::Finish (void){
+        State &s = Get ();
+        if (!s.enabled || s.current.empty ()){
+                return;
+        }
+        std::chrono::duration<double> elapsed = Clock::now () - s.phaseStart;
+        //Simulator::Destroy restarts the count when one process runs several simulations
+        uint64_t events = ns3::Simulator::GetEventCount ();
+        events = events >= s.phaseEvents ? events - s.phaseEvents : events;
+        s.phases.push_back (PhaseRecord {s.current, elapsed.count (), events});
+        s.current.clear ();
+}
+
+inline uint32_t SimProfiler::Register (std::string name){
+        State &s = Get ();
+        s.callbacks.push_back (CallbackRecord {name, 0, Clock::duration::zero ()});
+        return s.callbacks.size () - 1;
+}
+
+inline SimProfiler::Scope::Scope (uint32_t id)
+        : m_id (id)
+{
+        if (Get ().enabled){
+                m_start = Clock::now ();
+        }
+}
+
+inline SimProfiler::Scope::~Scope (){
+        State &s = Get ();
+        if (s.enabled){
+                s.callbacks[m_id].calls++;
+                s.callbacks[m_id].time += Clock::now () - m_start;
+        }
+}
+
+inline void SimProfiler::Write (std::string fileName){
+        State &s = Get ();
+        if (!s.enabled){
+                return;
+        }
+        Finish ();
+
+        struct rusage usage;
+        getrusage (RUSAGE_SELF, &usage);
+        double runSeconds = 0;
+        uint64_t events = 0;
+        double total = 0;
+        for (const PhaseRecord &p : s.phases){
+                total += p.seconds;
+                events += p.events;
+                if (p.name == "run"){
+                        runSeconds += p.seconds;
+                }
+        }
+
+        std::ofstream out (fileName);
+        out << "{\n  \"wallSeconds\": " << total
+            << ",\n  \"events\": " << events
+            << ",\n  \"eventsPerSecond\": " << (runSeconds > 0 ? events / runSeconds : 0)
+            << ",\n  \"peakRssKb\": " << usage.ru_maxrss
+            << ",\n  \"phases\": [";
+        for (size_t i = 0; i < s.phases.size (); i++){
+                out << (i ? ", " : "") << "{\"name\": \"" << s.phases[i].name << "\", \"seconds\": " << s.phases[i].seconds
+                    << ", \"events\": " << s.phases[i].events << "}";
+        }
+        out << "],\n  \"callbacks\": [";
+        for (size_t i = 0; i < s.callbacks.size (); i++){
+                double seconds = std::chrono::duration<double> (s.callbacks[i].time).count ();
+                out << (i ? ", " : "") << "{\"name\": \"" << s.callbacks[i].name << "\", \"calls\": " << s.callbacks[i].calls
+                    << ", \"seconds\": " << seconds << ", \"shareOfRun\": " << (runSeconds > 0 ? seconds / runSeconds : 0) << "}";
+        }
+        out << "]\n}\n";
+}
+
+#endif // SIM_PROFILER_H
@@ -0,0 +1,198 @@
+/*
+  Per-ACK cost benchmark for the TCP congestion operations.
+
+  Drives IncreaseWindow, PktsAcked and GetSsThresh of each congestion
+  control with a synthetic TcpSocketState and ACK stream, and reports the
+  nanoseconds and heap allocations per ACK. Scenarios:
+
+    ss     slow start only; cwnd restarts from one segment when it gets large
+    ca     congestion avoidance only
+    mixed  slow start, then a loss (GetSsThresh, cwnd = ssthresh) every
+           --lossEvery ACKs
+
+  TcpNewRenoPlusPow is the TcpNewRenoPlus slow start before the growth term
+  was cached. With --limit, the run fails if TcpNewRenoPlus costs more
+  than that many ns/ACK in any scenario.
+
+  ./waf --run "scratch/CongestionOpsBench --acks=1000000 --segmentsAcked=2"
+*/
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include "ns3/core-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/tcp-NewRenoPlus.h"
+
+using namespace ns3;
+using namespace std;
+
+NS_LOG_COMPONENT_DEFINE ("CongestionOpsBench");
+
+//Counts heap allocations of the whole program
+static atomic<uint64_t> g_allocations (0);
+
+void *operator new (size_t size){
+        g_allocations++;
+        void *p = malloc (size ? size : 1);
+        if (!p){
+                throw bad_alloc ();
+        }
+        return p;
+}
+
+void operator delete (void *p) noexcept{
+        free (p);
+}
+
+void operator delete (void *p, size_t) noexcept{
+        free (p);
+}
+
+//Previous TcpNewRenoPlus slow start, kept as the baseline of the comparison
+class TcpNewRenoPlusPow : public TcpNewReno{
+
+        protected:
+                virtual uint32_t SlowStart (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked);
+};
+
+uint32_t TcpNewRenoPlusPow::SlowStart (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked){
+        if (segmentsAcked >= 1){
+                double adder = static_cast<double> (pow(tcb->m_segmentSize, 1.91)) / tcb->m_cWnd.Get ();
+                tcb->m_cWnd += static_cast<uint32_t> (adder);
+                return segmentsAcked - 1;
+        }
+        return 0;
+}
+
+struct Result{
+        double nsPerAck;
+        double allocsPerAck;
+};
+
+static Result RunAcks (Ptr<TcpCongestionOps> cong, string scenario, uint32_t acks, uint32_t segmentsAcked,
+                       uint32_t segmentSize, uint32_t lossEvery){
+    //Decided once, so no string compare lands in the timed loop
+    const bool ca = scenario == "ca";
+    const bool losses = scenario == "mixed" && lossEvery > 0;
+    const uint32_t cWndReset = ca ? 100 * segmentSize : segmentSize;
+
+    Ptr<TcpSocketState> tcb = CreateObject<TcpSocketState> ();
+    tcb->m_segmentSize = segmentSize;
+    tcb->m_cWnd = cWndReset;
+    tcb->m_ssThresh = ca ? 10 * segmentSize : UINT32_MAX;
+    tcb->m_congState = TcpSocketState::CA_OPEN;
+    cong->Init (tcb);
+
+    uint32_t cWndCap = 4096 * segmentSize;
+    Time rtt = MilliSeconds (10);
+    SequenceNumber32 acked (1);
+
+    uint64_t allocations = g_allocations;
+    auto start = chrono::steady_clock::now ();
+    for (uint32_t i = 0; i < acks; i++){
+        acked += segmentsAcked * segmentSize;
+        tcb->m_lastAckedSeq = acked;
+        tcb->m_highTxMark = acked + tcb->m_cWnd.Get ();
+        tcb->m_bytesInFlight = tcb->m_cWnd.Get ();
+        cong->PktsAcked (tcb, segmentsAcked, rtt);
+        cong->IncreaseWindow (tcb, segmentsAcked);
+
+        if (losses && i % lossEvery == lossEvery - 1){
+            tcb->m_ssThresh = cong->GetSsThresh (tcb, tcb->m_bytesInFlight);
+            tcb->m_cWnd = tcb->m_ssThresh.Get ();
+        }
+        else if (tcb->m_cWnd.Get () > cWndCap){
+            tcb->m_cWnd = cWndReset;
+        }
+    }
+    chrono::duration<double, nano> elapsed = chrono::steady_clock::now () - start;
+    allocations = g_allocations - allocations;
+
+    return Result {elapsed.count () / acks, static_cast<double> (allocations) / acks};
+}
+
+//Creates a congestion control by TypeId name with attribute overrides, or 0 if it is not in this ns-3
+static Ptr<TcpCongestionOps> Create (string name, vector<pair<string, string> > attributes){
+    TypeId tid;
+    if (!TypeId::LookupByNameFailSafe ("ns3::" + name, &tid)){
+        return 0;
+    }
+    ObjectFactory factory;
+    factory.SetTypeId (tid);
+    for (const pair<string, string> &a : attributes){
+        factory.Set (a.first, StringValue (a.second));
+    }
+    return factory.Create<TcpCongestionOps> ();
+}
+
+int main (int argc, char *argv[]){
+    uint32_t acks = 1000000;
+    uint32_t segmentsAcked = 1;
+    uint32_t segmentSize = 1448;
+    uint32_t lossEvery = 5000;
+    double limit = 0;
+
+    CommandLine cmd;
+    cmd.AddValue ("acks", "Number of ACKs fed to each congestion control per scenario", acks);
+    cmd.AddValue ("segmentsAcked", "Segments covered by each ACK", segmentsAcked);
+    cmd.AddValue ("segmentSize", "Segment size in bytes", segmentSize);
+    cmd.AddValue ("lossEvery", "ACKs between losses in the mixed scenario", lossEvery);
+    cmd.AddValue ("limit", "Fail if TcpNewRenoPlus exceeds this many ns/ACK (0 to disable)", limit);
+    cmd.Parse (argc, argv);
+
+    struct Candidate{
+        string label;
+        string type;
+        vector<pair<string, string> > attributes;
+    };
+    vector<Candidate> candidates = {
+        {"TcpNewRenoPlus", "TcpNewRenoPlus", {}},
+        {"TcpNewRenoPlus+stretch", "TcpNewRenoPlus", {{"StretchAckGrowth", "true"}}},
+        {"TcpNewRenoPlus+pacing+hystart", "TcpNewRenoPlus", {{"Pacing", "true"}, {"HyStart", "true"}}},
+        {"TcpNewReno", "TcpNewReno", {}},
+        {"TcpCubic", "TcpCubic", {}},
+        {"TcpBic", "TcpBic", {}},
+        {"TcpHighSpeed", "TcpHighSpeed", {}},
+        {"TcpHtcp", "TcpHtcp", {}},
+        {"TcpScalable", "TcpScalable", {}},
+        {"TcpVegas", "TcpVegas", {}},
+        {"TcpVeno", "TcpVeno", {}},
+        {"TcpYeah", "TcpYeah", {}},
+        {"TcpIllinois", "TcpIllinois", {}},
+        {"TcpHybla", "TcpHybla", {}},
+        {"TcpLedbat", "TcpLedbat", {}},
+        {"TcpLinuxReno", "TcpLinuxReno", {}},
+    };
+
+    cout << "segmentsAcked " << segmentsAcked << " segmentSize " << segmentSize << " acks " << acks << endl;
+    cout << left << setw (32) << "congestion control" << setw (8) << "scenario"
+         << right << setw (12) << "ns/ACK" << setw (14) << "allocs/ACK" << endl;
+
+    bool failed = false;
+    const char *scenarios[] = {"ss", "ca", "mixed"};
+    for (const char *scenario : scenarios){
+        Result baseline = RunAcks (CreateObject<TcpNewRenoPlusPow> (), scenario, acks, segmentsAcked, segmentSize, lossEvery);
+        cout << left << setw (32) << "TcpNewRenoPlusPow" << setw (8) << scenario
+             << right << setw (12) << baseline.nsPerAck << setw (14) << baseline.allocsPerAck << endl;
+
+        for (const Candidate &c : candidates){
+            Ptr<TcpCongestionOps> cong = Create (c.type, c.attributes);
+            if (!cong){
+                continue;
+            }
+            Result r = RunAcks (cong, scenario, acks, segmentsAcked, segmentSize, lossEvery);
+            cout << left << setw (32) << c.label << setw (8) << scenario
+                 << right << setw (12) << r.nsPerAck << setw (14) << r.allocsPerAck << endl;
+            if (limit > 0 && c.label == "TcpNewRenoPlus" && r.nsPerAck > limit){
+                cerr << "TcpNewRenoPlus " << scenario << ": " << r.nsPerAck << " ns/ACK exceeds the limit of " << limit << endl;
+                failed = true;
+            }
+        }
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,63 @@
+/*
+  Builds and queries the columnar cwnd store (cwnd-store.h).
+
+  CwndStore build <trace.bin> <store.cwndc>
+      converts a binary trace written by First --cwndTrace=binary
+  CwndStore extract <store.cwndc> <label> [t0 t1 [points]]
+      prints "time diff cwnd" lines of one flow between t0 and t1, in the
+      .cwnd text format, downsampled to at most points lines; diff is taken
+      from the previous printed line
+
+  The congestion*.plt scripts read their flows through extract, with
+  build/lib on LD_LIBRARY_PATH as runA.sh sets it, e.g.
+  plot "< ./build/scratch/CwndStore extract TcpNewReno_cwnd.cwndc N1_1 0 30 2000" using 1:3
+*/
+
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <string>
+#include "cwnd-store.h"
+
+using namespace std;
+
+int main (int argc, char *argv[]){
+    string command = argc > 1 ? argv[1] : "";
+
+    if (command == "build" && argc == 4){
+        string error = BuildCwndStore (argv[2], argv[3]);
+        if (!error.empty ()){
+            cerr<<error<<endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    if (command == "extract" && argc >= 4 && argc <= 7){
+        CwndStoreReader reader;
+        string error = reader.Open (argv[2]);
+        if (!error.empty ()){
+            cerr<<error<<endl;
+            return 1;
+        }
+        uint32_t flow = reader.FindFlow (argv[3]);
+        if (flow == reader.FlowCount ()){
+            cerr<<"No flow "<<argv[3]<<" in "<<argv[2]<<endl;
+            return 1;
+        }
+        double t0 = argc > 4 ? atof (argv[4]) : 0;
+        double t1 = argc > 5 ? atof (argv[5]) : numeric_limits<double>::max ();
+        uint32_t points = argc > 6 ? atoi (argv[6]) : numeric_limits<uint32_t>::max ();
+
+        uint32_t last = 0;
+        for (const CwndPoint &p : reader.Downsample (flow, t0, t1, points)){
+            cout << p.time << " " << p.cwnd - last << " " << p.cwnd << "\n";
+            last = p.cwnd;
+        }
+        return 0;
+    }
+
+    cerr<<"Usage: "<<argv[0]<<" build <trace.bin> <store.cwndc>"<<endl;
+    cerr<<"       "<<argv[0]<<" extract <store.cwndc> <label> [t0 t1 [points]]"<<endl;
+    return 1;
+}
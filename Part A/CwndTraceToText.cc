@@ -0,0 +1,81 @@
+/*
+  Converts a binary cwnd trace written by First --cwndTrace=binary into the
+  "<prefix>_<label>_Source.cwnd" text files read by the congestion*.plt scripts.
+
+  ./waf --run "scratch/CwndTraceToText TcpNewRenoPlus_cwnd.bin TcpNewRenoPlus"
+*/
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "cwnd-trace.h"
+
+using namespace std;
+
+int main (int argc, char *argv[]){
+    if (argc != 3){
+        cerr<<"Usage: "<<argv[0]<<" <trace.bin> <output prefix>"<<endl;
+        return 1;
+    }
+
+    FILE *in = fopen (argv[1], "rb");
+    if (!in){
+        cerr<<"Cannot open "<<argv[1]<<endl;
+        return 1;
+    }
+
+    CwndTraceHeader header;
+    CwndTraceFooter footer;
+    if (fread (&header, sizeof (header), 1, in) != 1 || header.magic != CWND_TRACE_MAGIC
+        || header.version != CWND_TRACE_VERSION || header.recordSize != sizeof (CwndRecord)){
+        cerr<<argv[1]<<" is not a cwnd trace"<<endl;
+        return 1;
+    }
+    if (fseek (in, -static_cast<long> (sizeof (footer)), SEEK_END) != 0
+        || fread (&footer, sizeof (footer), 1, in) != 1 || footer.magic != CWND_TRACE_MAGIC){
+        cerr<<argv[1]<<" is truncated"<<endl;
+        return 1;
+    }
+
+    //Flow labels, one output file each
+    fseek (in, footer.labelsOffset, SEEK_SET);
+    vector<unique_ptr<ofstream> > out;
+    for (uint32_t i = 0; i < footer.nFlows; i++){
+        uint32_t length;
+        if (fread (&length, sizeof (length), 1, in) != 1){
+            cerr<<argv[1]<<" is truncated"<<endl;
+            return 1;
+        }
+        string label (length, ' ');
+        if (length > 0 && fread (&label[0], 1, length, in) != length){
+            cerr<<argv[1]<<" is truncated"<<endl;
+            return 1;
+        }
+        out.emplace_back (new ofstream (string (argv[2]) + "_" + label + "_Source.cwnd"));
+    }
+
+    //Records, streamed in blocks
+    fseek (in, sizeof (header), SEEK_SET);
+    uint64_t remaining = (footer.labelsOffset - sizeof (header)) / sizeof (CwndRecord);
+    vector<CwndRecord> block (1 << 16);
+    while (remaining > 0){
+        size_t n = fread (block.data (), sizeof (CwndRecord), min<uint64_t> (remaining, block.size ()), in);
+        if (n == 0){
+            cerr<<argv[1]<<" is truncated"<<endl;
+            return 1;
+        }
+        for (size_t i = 0; i < n; i++){
+            const CwndRecord &r = block[i];
+            if (r.flow < out.size ()){
+                *out[r.flow] << r.time << " " << r.newCwnd - r.oldCwnd << " " << r.newCwnd << "\n";
+            }
+        }
+        remaining -= n;
+    }
+
+    fclose (in);
+    return 0;
+}
@@ -1,4 +1,6 @@
 /*
+   Default (--topology=star, 2 senders, the three flows of the assignment):
+
               Node1
               / 
              / 10.10.1.0/24
@@ -9,12 +11,39 @@
               \
               Node2
 
+   --topology=dumbbell: every sender reaches its own receiver through a
+   shared bottleneck between two routers.
+
+      S0 \                     / D0
+      S1 -- R0 ==bottleneck== R1 -- D1
+      Sn /                     \ Dn
+
+   --topology=parkinglot: routers R0..Rh in a chain ending at one receiver,
+   sender i joins at router i % h, so flows cross different numbers of hops.
+
+      S0   S1        Sh-1
+      |    |          |
+      R0 = R1 = ... = Rh-1 = Rh -- D
+
+   --topology=lfn: one long fat link of --bottleneckRate and --rtt between
+   sender 0 and the receiver, buffered to one bandwidth-delay product unless
+   --queueSize is given, and without link errors unless --errorRate is
+   given. Flows are bulk, socket buffers are sized to twice
+   the BDP and the run reports the time to --utilTarget of the link,
+   window scaling and SACK as negotiated, and simulator events/s.
+
+      S0 ==== 10Gbps, 100ms RTT ==== D
+
+   Flows come from --flowsFile (lines "label sender start stop rate"), from
+   --flows=N (spread over the senders, one every --flowSpacing seconds), or
+   default to the three flows of the assignment.
 */
  
 #include <fstream>
 #include <string>
 #include <string>
 #include <cassert>
+#include <cerrno>
 #include "ns3/core-module.h"
 #include "ns3/network-module.h"
 #include "ns3/point-to-point-module.h"
@@ -30,7 +59,16 @@
 #include "ns3/double.h"
 #include "ns3/tcp-socket-base.h"
 #include "ns3/tcp-l4-protocol.h"
+#include "ns3/traffic-control-module.h"
 #include <bits/stdc++.h>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "cwnd-trace.h"
+#include "cwnd-bins.h"
+#include "drop-stats.h"
+#include "flow-report.h"
+#include "sim-profiler.h"
 
 using namespace ns3;
 using namespace std;
@@ -43,13 +81,21 @@ class MyApp : public Application{
         public:
                 MyApp ();
                 virtual ~MyApp();
-                void Setup (Ptr<Socket> socket, Address address, uint32_t packetSize, uint32_t nPackets, DataRate dataRate);
+                void Setup (Ptr<Socket> socket, Address address, uint32_t packetSize, uint32_t nPackets, DataRate dataRate, uint32_t batch = 1, bool bulk = false);
+
+                uint64_t GetBytesSent (void) const;
+                //Sends refused by a full socket buffer (rate mode)
+                uint32_t GetSendsRefused (void) const;
+                //Time spent waiting for socket buffer space with data left to send (bulk mode)
+                Time GetBufferFullTime (void) const;
 
         private:
                 virtual void StartApplication (void);
                 virtual void StopApplication (void);
                 void ScheduleTx (void);
                 void SendPacket (void);
+                void SendData (void);
+                void DataSend (Ptr<Socket> socket, uint32_t available);
 
                 Ptr<Socket>     m_socket;
                 Address         m_peer;
@@ -59,6 +105,13 @@ class MyApp : public Application{
                 EventId         m_sendEvent;
                 bool            m_running;
                 uint32_t        m_packetsSent;
+                uint32_t        m_batch;        // packets sent per send event
+                Ptr<Packet>     m_packet;       // template, sent as copy-on-write copies
+                bool            m_bulk;         // fill the socket buffer whenever it has space
+                uint64_t        m_bytesSent;
+                uint32_t        m_sendsRefused;
+                Time            m_bufferFullSince;
+                Time            m_bufferFullTime;
 };
 
 //Constructor and Destructor
@@ -70,20 +123,43 @@ MyApp::MyApp ()
         m_dataRate (0),
         m_sendEvent (),
         m_running (false),
-        m_packetsSent (0)
+        m_packetsSent (0),
+        m_batch (1),
+        m_packet (0),
+        m_bulk (false),
+        m_bytesSent (0),
+        m_sendsRefused (0),
+        m_bufferFullSince (Time (0)),
+        m_bufferFullTime (Time (0))
 {
 }
 
 MyApp::~MyApp(){
         m_socket = 0;
+        m_packet = 0;
 }
 
-void MyApp::Setup (Ptr<Socket> socket, Address address, uint32_t packetSize, uint32_t nPackets, DataRate dataRate){
+void MyApp::Setup (Ptr<Socket> socket, Address address, uint32_t packetSize, uint32_t nPackets, DataRate dataRate, uint32_t batch, bool bulk){
         m_socket = socket;
         m_peer = address;
         m_packetSize = packetSize;
         m_nPackets = nPackets;
         m_dataRate = dataRate;
+        m_batch = max<uint32_t> (batch, 1);
+        m_packet = Create<Packet> (m_packetSize);
+        m_bulk = bulk;
+}
+
+uint64_t MyApp::GetBytesSent (void) const{
+        return m_bytesSent;
+}
+
+uint32_t MyApp::GetSendsRefused (void) const{
+        return m_sendsRefused;
+}
+
+Time MyApp::GetBufferFullTime (void) const{
+        return m_bufferFullTime;
 }
 
 //Initializing member variables
@@ -92,12 +168,22 @@ void MyApp::StartApplication (void){
         m_packetsSent = 0;
         m_socket->Bind ();
         m_socket->Connect (m_peer);
-        SendPacket ();
+        if (m_bulk){
+                m_socket->SetSendCallback (MakeCallback (&MyApp::DataSend, this));
+                SendData ();
+        }
+        else{
+                SendPacket ();
+        }
 }
 
 //Stop creating simulation events
 void MyApp::StopApplication (void){
         m_running = false;
+        if (!m_bufferFullSince.IsZero ()){
+                m_bufferFullTime += Simulator::Now () - m_bufferFullSince;
+                m_bufferFullSince = Time (0);
+        }
         if (m_sendEvent.IsRunning ()){
                 Simulator::Cancel (m_sendEvent);
         }
@@ -107,14 +193,45 @@ void MyApp::StopApplication (void){
 }
 
 //Recall that StartApplication called SendPacket to start the chain of events that describes the Application behavior
+//Copies of the template share its zero-filled buffer, so no packet data is allocated per send
 void MyApp::SendPacket (void){
-        Ptr<Packet> packet = Create<Packet> (m_packetSize);
-        m_socket->Send (packet);
-        if (++m_packetsSent < m_nPackets){
+        for (uint32_t i = 0; i < m_batch && m_packetsSent < m_nPackets; i++){
+                if (m_socket->Send (m_packet->Copy ()) < 0){
+                        m_sendsRefused++;
+                }
+                else{
+                        m_bytesSent += m_packetSize;
+                }
+                m_packetsSent++;
+        }
+        if (m_packetsSent < m_nPackets){
                 ScheduleTx ();
         }
 }
 
+//Bulk mode: queue packets while the socket buffer has room, then wait for DataSend
+void MyApp::SendData (void){
+        while (m_running && m_packetsSent < m_nPackets && m_socket->GetTxAvailable () >= m_packetSize){
+                if (m_socket->Send (m_packet->Copy ()) < 0){
+                        break;
+                }
+                m_bytesSent += m_packetSize;
+                m_packetsSent++;
+        }
+        if (m_running && m_packetsSent < m_nPackets && m_bufferFullSince.IsZero ()){
+                m_bufferFullSince = Simulator::Now ();
+        }
+}
+
+//Socket buffer space was freed
+void MyApp::DataSend (Ptr<Socket> socket, uint32_t available){
+        if (!m_bufferFullSince.IsZero ()){
+                m_bufferFullTime += Simulator::Now () - m_bufferFullSince;
+                m_bufferFullSince = Time (0);
+        }
+        SendData ();
+}
+
 //Call ScheduleTx to schedule another transmit event (a SendPacket) until the Application decides it has sent enough.
 void MyApp::ScheduleTx (void){
         if (m_running){
@@ -123,20 +240,336 @@ void MyApp::ScheduleTx (void){
                 if(time>=30.0 && m_socket->GetSocketType() == 2){
                         m_dataRate = DataRate("500Kbps");
                 }
-                Time tNext (Seconds (m_packetSize * 8 / static_cast<double> (m_dataRate.GetBitRate())));
+                Time tNext (Seconds (m_packetSize * 8 * static_cast<double> (m_batch) / static_cast<double> (m_dataRate.GetBitRate())));
                 m_sendEvent = Simulator::Schedule (tNext, &MyApp::SendPacket, this);
         }
 }
 
 static void CwndChange (Ptr<OutputStreamWrapper> stream, uint32_t oldCwnd, uint32_t newCwnd){
+  static const uint32_t profileId = SimProfiler::Register ("CwndChange");
+  SimProfiler::Scope scope (profileId);
   *stream->GetStream () << Simulator::Now ().GetSeconds () << " " << newCwnd-oldCwnd << " " << newCwnd << std::endl;
 }
 
-int c=0;
+static void CwndChangeBinary (CwndTraceWriter *writer, uint32_t flow, uint32_t oldCwnd, uint32_t newCwnd){
+  static const uint32_t profileId = SimProfiler::Register ("CwndChangeBinary");
+  SimProfiler::Scope scope (profileId);
+  writer->Append (Simulator::Now ().GetSeconds (), flow, oldCwnd, newCwnd);
+}
+
+static void SsThreshChange (CwndTraceWriter *writer, uint32_t flow, uint32_t oldValue, uint32_t newValue){
+  writer->SetSsThresh (flow, newValue);
+}
+
+static void CongStateChange (CwndTraceWriter *writer, uint32_t flow, TcpSocketState::TcpCongState_t oldState, TcpSocketState::TcpCongState_t newState){
+  writer->SetState (flow, newState);
+}
+
+static void CwndBin (CwndBinner *binner, uint32_t flow, uint32_t oldValue, uint32_t newValue){
+  static const uint32_t profileId = SimProfiler::Register ("CwndBin");
+  SimProfiler::Scope scope (profileId);
+  binner->Update (flow, CwndBinner::CWND, Simulator::Now ().GetSeconds (), newValue);
+}
+
+static void SsThreshBin (CwndBinner *binner, uint32_t flow, uint32_t oldValue, uint32_t newValue){
+  binner->Update (flow, CwndBinner::SSTHRESH, Simulator::Now ().GetSeconds (), newValue);
+}
+
+static void RttBin (CwndBinner *binner, uint32_t flow, Time oldValue, Time newValue){
+  static const uint32_t profileId = SimProfiler::Register ("RttBin");
+  SimProfiler::Scope scope (profileId);
+  binner->Update (flow, CwndBinner::RTT, Simulator::Now ().GetSeconds (), newValue.GetSeconds () * 1000);
+}
+
+static void InFlightBin (CwndBinner *binner, uint32_t flow, uint32_t oldValue, uint32_t newValue){
+  static const uint32_t profileId = SimProfiler::Register ("InFlightBin");
+  SimProfiler::Scope scope (profileId);
+  binner->Update (flow, CwndBinner::INFLIGHT, Simulator::Now ().GetSeconds (), newValue);
+}
+
+//Per-flow figures written to --metricsFile and compared across replications
+struct FlowMetrics{
+    uint64_t retransmissions;
+    SequenceNumber32 highestTx;
+    bool sent;
+    uint32_t cwnd;
+    uint32_t cwndMax;
+    double cwndArea;    // cwnd integrated over time, for the time-weighted mean
+    double firstChange;
+    double lastChange;
+};
+
+//A data segment starting below the highest sequence sent so far is a retransmission
+static void TxMetrics (FlowMetrics *m, Ptr<const Packet> p, const TcpHeader &header, Ptr<const TcpSocketBase> socket){
+  static const uint32_t profileId = SimProfiler::Register ("TxMetrics");
+  SimProfiler::Scope scope (profileId);
+  if (p->GetSize () == 0){
+    return;
+  }
+  if (m->sent && header.GetSequenceNumber () < m->highestTx){
+    m->retransmissions++;
+  }
+  else{
+    m->highestTx = header.GetSequenceNumber () + p->GetSize ();
+    m->sent = true;
+  }
+}
 
-static void RxDrop(Ptr<const Packet> p){
-  c++;
-  NS_LOG_UNCOND("RxDrop at " << Simulator::Now().GetSeconds());
+static void CwndMetrics (FlowMetrics *m, uint32_t oldCwnd, uint32_t newCwnd){
+  static const uint32_t profileId = SimProfiler::Register ("CwndMetrics");
+  SimProfiler::Scope scope (profileId);
+  double now = Simulator::Now ().GetSeconds ();
+  if (m->firstChange < 0){
+    m->firstChange = now;
+  }
+  else{
+    m->cwndArea += m->cwnd * (now - m->lastChange);
+  }
+  m->cwnd = newCwnd;
+  m->cwndMax = max (m->cwndMax, newCwnd);
+  m->lastChange = now;
+}
+
+//Bottleneck utilisation of the --topology=lfn run, sampled from the sinks
+struct UtilMonitor{
+    vector<Ptr<PacketSink> > sinks;
+    double capacity;    // bit/s
+    double interval;    // seconds between samples
+    double target;      // fraction of capacity
+    double start;       // when the first flow started
+    uint64_t lastRx;
+    double reached;     // seconds after start, -1 until the target is met
+    double peak;        // highest utilisation of any interval
+};
+
+static void SampleUtilisation (UtilMonitor *u){
+  uint64_t rx = 0;
+  for (Ptr<PacketSink> sink : u->sinks){
+    rx += sink->GetTotalRx ();
+  }
+  double now = Simulator::Now ().GetSeconds ();
+  double utilisation = (rx - u->lastRx) * 8 / u->interval / u->capacity;
+  u->lastRx = rx;
+  u->peak = max (u->peak, utilisation);
+  if (u->reached < 0 && utilisation >= u->target && now > u->start){
+    u->reached = now - u->start;
+  }
+  Simulator::Schedule (Seconds (u->interval), &SampleUtilisation, u);
+}
+
+//Largest receive window the sender was offered; above 65535 only with window scaling
+static void RwndMax (uint32_t *rwndMax, uint32_t oldValue, uint32_t newValue){
+  *rwndMax = max (*rwndMax, newValue);
+}
+
+//Two-sided 95% Student t quantiles for 1..30 degrees of freedom
+static double TQuantile95 (uint32_t df){
+    static const double t[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                               2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+                               2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+    return df == 0 ? 0 : df <= 30 ? t[df - 1] : 1.96;
+}
+
+//Runs this program once per replication with consecutive RngRun values, jobs at a time,
+//then prints the mean and 95% confidence interval of every per-flow metric
+static int RunReplications (int argc, char *argv[], uint32_t replications, uint32_t jobs, string prefix){
+    static const char *names[] = {"goodput(Mbps)", "drops", "retransmissions", "cwndMean", "cwndMax"};
+    const uint32_t nMetrics = 5;
+    uint64_t baseRun = RngSeedManager::GetRun ();
+
+    uint32_t running = 0;
+    map<pid_t, uint32_t> children;
+    vector<uint32_t> failed;
+    for (uint32_t r = 0; r < replications || running > 0; ){
+        if (r < replications && running < jobs){
+            string rep = prefix + "_rep" + to_string (r);
+            vector<string> args (argv, argv + argc);
+            args.push_back ("--replications=1");
+            args.push_back ("--RngRun=" + to_string (baseRun + r));
+            args.push_back ("--metricsFile=" + rep + ".metrics");
+            //Replications run side by side and would share every per-prefix output file
+            args.push_back ("--traceFlows=0");
+            args.push_back ("--cwndTrace=text");
+            args.push_back ("--dropTrace=false");
+            args.push_back ("--flowMonitor=false");
+            args.push_back ("--profile=");
+            vector<char *> childArgv;
+            for (string &a : args){
+                childArgv.push_back (&a[0]);
+            }
+            childArgv.push_back (0);
+            string log = rep + ".log";
+            //A file left by an earlier run must not stand in for one that fails now
+            unlink ((rep + ".metrics").c_str ());
+            pid_t pid = fork ();
+            if (pid == 0){
+                int fd = open (log.c_str (), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+                if (fd < 0 || dup2 (fd, STDOUT_FILENO) < 0){
+                    _exit (126);
+                }
+                execv ("/proc/self/exe", childArgv.data ());
+                _exit (127);
+            }
+            NS_ABORT_MSG_IF (pid < 0, "Cannot start replication " << r);
+            children[pid] = r;
+            running++;
+            r++;
+        }
+        else{
+            int status;
+            pid_t pid;
+            do{
+                pid = wait (&status);
+            } while (pid < 0 && errno == EINTR);
+            NS_ABORT_MSG_IF (pid < 0, "Lost track of the replications");
+            map<pid_t, uint32_t>::iterator child = children.find (pid);
+            if (child == children.end ()){
+                continue;
+            }
+            running--;
+            if (!WIFEXITED (status) || WEXITSTATUS (status) != 0){
+                failed.push_back (child->second);
+            }
+            children.erase (child);
+        }
+    }
+    if (!failed.empty ()){
+        sort (failed.begin (), failed.end ());
+        for (uint32_t r : failed){
+            cerr<<"Replication "<<r<<" failed, see "<<prefix<<"_rep"<<r<<".log"<<endl;
+        }
+        NS_ABORT_MSG (failed.size () << " of " << replications << " replications failed");
+    }
+
+    //label -> metric -> one value per replication
+    map<string, vector<vector<double> > > values;
+    vector<string> order;
+    for (uint32_t r = 0; r < replications; r++){
+        ifstream in (prefix + "_rep" + to_string (r) + ".metrics");
+        NS_ABORT_MSG_UNLESS (in.is_open (), "Replication " << r << " wrote no metrics, see " << prefix << "_rep" << r << ".log");
+        string label;
+        while (in >> label){
+            if (values.find (label) == values.end ()){
+                values[label].resize (nMetrics);
+                order.push_back (label);
+            }
+            for (uint32_t k = 0; k < nMetrics; k++){
+                double v;
+                in >> v;
+                values[label][k].push_back (v);
+            }
+        }
+    }
+
+    cout<<replications<<" replications, RngRun "<<baseRun<<" to "<<baseRun + replications - 1<<", mean +- 95% CI"<<endl;
+    for (const string &label : order){
+        cout<<"Flow "<<label;
+        for (uint32_t k = 0; k < nMetrics; k++){
+            const vector<double> &v = values[label][k];
+            double mean = accumulate (v.begin (), v.end (), 0.0) / v.size ();
+            double var = 0;
+            for (double x : v){
+                var += (x - mean) * (x - mean);
+            }
+            var = v.size () > 1 ? var / (v.size () - 1) : 0;
+            double half = TQuantile95 (v.size () - 1) * sqrt (var / v.size ());
+            cout<<" "<<names[k]<<": "<<mean<<" +- "<<half;
+        }
+        cout<<endl;
+    }
+    return 0;
+}
+
+struct FlowSpec{
+    string label;       // used in the cwnd trace file name
+    uint32_t sender;    // index of the sender node
+    double start;
+    double stop;
+    string rate;
+};
+
+//Splits "a,b,c"; a single value applies to every link
+static vector<string> SplitList (string list){
+    vector<string> items;
+    stringstream ss (list);
+    string item;
+    while (getline (ss, item, ',')){
+        items.push_back (item);
+    }
+    return items;
+}
+
+static vector<FlowSpec> ReadFlowsFile (string fileName){
+    vector<FlowSpec> flows;
+    ifstream in (fileName);
+    NS_ABORT_MSG_UNLESS (in.is_open (), "Cannot open flows file " << fileName);
+    string line;
+    while (getline (in, line)){
+        if (line.empty () || line[0] == '#'){
+            continue;
+        }
+        FlowSpec f;
+        stringstream ss (line);
+        NS_ABORT_MSG_UNLESS (ss >> f.label >> f.sender >> f.start >> f.stop >> f.rate, "Bad flow line: " << line);
+        flows.push_back (f);
+    }
+    return flows;
+}
+
+//Builds point-to-point links, numbering each one as its own /24
+class LinkBuilder{
+
+        public:
+                //aqm is a queue disc type installed on the sending end of every link, or
+                //empty for drop-tail in the device queue alone
+                LinkBuilder (string queueSize, Ptr<ErrorModel> em, string aqm, bool ecn);
+                //a is the upstream (sender side) end, b the downstream end
+                Ipv4InterfaceContainer Link (Ptr<Node> a, Ptr<Node> b, string rate, string delay);
+
+                vector<Ptr<NetDevice> > m_downstream;  // receiving devices, where drops are traced
+
+        private:
+                PointToPointHelper      m_p2p;
+                Ipv4AddressHelper       m_ipv4;
+                Ptr<ErrorModel>         m_em;
+                bool                    m_aqm;
+                TrafficControlHelper    m_tch;
+};
+
+LinkBuilder::LinkBuilder (string queueSize, Ptr<ErrorModel> em, string aqm, bool ecn)
+        : m_em (em),
+        m_aqm (!aqm.empty ())
+{
+        // With an AQM the queue should build in the queue disc, not in the device
+        if (queueSize.empty () && m_aqm){
+                queueSize = "1p";
+        }
+        if (!queueSize.empty ()){
+                m_p2p.SetQueue ("ns3::DropTailQueue<Packet>", "MaxSize", StringValue (queueSize));
+        }
+        if (m_aqm){
+                m_tch.SetRootQueueDisc (aqm, "UseEcn", BooleanValue (ecn));
+        }
+        m_ipv4.SetBase ("10.10.1.0", "255.255.255.0");
+}
+
+Ipv4InterfaceContainer LinkBuilder::Link (Ptr<Node> a, Ptr<Node> b, string rate, string delay){
+        m_p2p.SetDeviceAttribute ("DataRate", StringValue (rate));
+        m_p2p.SetChannelAttribute ("Delay", StringValue (delay));
+        NetDeviceContainer devices = m_p2p.Install (a, b);
+        devices.Get (1)->SetAttribute ("ReceiveErrorModel", PointerValue (m_em));
+        m_downstream.push_back (devices.Get (1));
+        //Must precede Assign, which otherwise installs the default queue disc
+        if (m_aqm){
+                m_tch.Install (devices.Get (0));
+        }
+        Ipv4InterfaceContainer interfaces = m_ipv4.Assign (devices);
+        //Without an AQM, take away the default (FqCoDel since ns-3.30) that Assign added
+        if (!m_aqm){
+                m_tch.Uninstall (devices);
+        }
+        m_ipv4.NewNetwork ();
+        return interfaces;
 }
 
 
@@ -145,133 +578,442 @@ int main (int argc, char *argv[]){
     uint32_t nPackets=100000;
 
     std::string tcp_t;
+    bool pacing = false;
+    uint32_t pacingSsRatio = 200;
+    uint32_t pacingCaRatio = 120;
+    bool delayCa = false;
+    string recovery = "";
+    string topology = "star";
+    uint32_t nSenders = 2;
+    uint32_t hops = 2;
+    string accessRate = "10Mbps,9Mbps";
+    string accessDelay = "3ms";
+    string bottleneckRate = "10Mbps";
+    string bottleneckDelay = "3ms";
+    string queueSize = "";
+    string aqm = "none";
+    bool ecn = false;
+    double errorRate = -1;      // 0.00001, or 0 for --topology=lfn, unless given
+    uint32_t nFlows = 0;
+    string flowsFile = "";
+    double flowStart = 1.0;
+    double flowSpacing = 0.01;
+    double flowDuration = 20.0;
+    string appRate = "1.5Mbps";
+    double simTime = 30.0;
+    uint32_t traceFlows = 3;
+    string cwndTrace = "text";
+    double binWidth = 0.01;
+    double dropBucket = 0.1;
+    bool dropTrace = false;
+    uint32_t batch = 1;
+    bool bulk = false;
+    uint32_t replications = 1;
+    uint32_t jobs = max (thread::hardware_concurrency (), 1u);
+    string metricsFile = "";
+    bool flowMonitor = false;
+    string profile = "";
+    double flowMonitorInterval = 0.1;
+    string rtt = "100ms";
+    double utilTarget = 0.9;
+    double utilInterval = 0.1;
 
     CommandLine cmd;
     cmd.AddValue ("tcp", "turn on log components", tcp_t);
+    cmd.AddValue ("pacing", "Let TcpNewRenoPlus pace the sockets at a rate derived from cwnd/RTT", pacing);
+    cmd.AddValue ("pacingSsRatio", "Pacing rate in slow start, as a percentage of cwnd/RTT", pacingSsRatio);
+    cmd.AddValue ("pacingCaRatio", "Pacing rate in congestion avoidance, as a percentage of cwnd/RTT", pacingCaRatio);
+    cmd.AddValue ("delayCa", "Let TcpNewRenoPlus use its delay-based congestion avoidance (DelayBasedCa)", delayCa);
+    cmd.AddValue ("recovery", "Loss recovery, e.g. TcpPrrRecovery or TcpRandomLossPrrRecovery (empty for the ns-3 default)", recovery);
+    cmd.AddValue ("topology", "star, dumbbell, parkinglot or lfn", topology);
+    cmd.AddValue ("senders", "Number of sender nodes", nSenders);
+    cmd.AddValue ("hops", "Bottleneck hops of the parking lot", hops);
+    cmd.AddValue ("rtt", "Round trip time of the lfn link", rtt);
+    cmd.AddValue ("utilTarget", "Utilisation of the lfn link whose time to reach is reported", utilTarget);
+    cmd.AddValue ("utilInterval", "Seconds between lfn utilisation samples", utilInterval);
+    cmd.AddValue ("accessRate", "Sender link rates, comma separated, cycled over the senders", accessRate);
+    cmd.AddValue ("accessDelay", "Sender link delays, comma separated, cycled over the senders", accessDelay);
+    cmd.AddValue ("bottleneckRate", "Rate of the dumbbell/parking lot bottleneck links", bottleneckRate);
+    cmd.AddValue ("bottleneckDelay", "Delay of the dumbbell/parking lot bottleneck links", bottleneckDelay);
+    cmd.AddValue ("queueSize", "Device queue size, e.g. 100p (empty for the ns-3 default)", queueSize);
+    cmd.AddValue ("aqm", "Queue disc on the sending end of every link: none (drop-tail device queue only), FqCoDel, PIE or RED", aqm);
+    cmd.AddValue ("ecn", "Negotiate ECN on the TCP connections and mark instead of drop in the AQM", ecn);
+    cmd.AddValue ("errorRate", "Receive error rate of every link (default 0.00001, 0 for the lfn topology)", errorRate);
+    cmd.AddValue ("flows", "Generate this many flows instead of the three default ones", nFlows);
+    cmd.AddValue ("flowsFile", "File of \"label sender start stop rate\" flow lines", flowsFile);
+    cmd.AddValue ("flowStart", "Start time of the first generated flow", flowStart);
+    cmd.AddValue ("flowSpacing", "Seconds between the starts of generated flows", flowSpacing);
+    cmd.AddValue ("flowDuration", "Duration of each generated flow", flowDuration);
+    cmd.AddValue ("appRate", "Application data rate of each generated flow", appRate);
+    cmd.AddValue ("simTime", "Simulation stop time", simTime);
+    cmd.AddValue ("traceFlows", "Number of flows whose cwnd is traced to a file", traceFlows);
+    cmd.AddValue ("batch", "Packets each MyApp sends per send event", batch);
+    cmd.AddValue ("bulk", "Fill the socket buffer whenever it has space instead of sending at appRate", bulk);
+    cmd.AddValue ("replications", "Run this many replications with consecutive RngRun values and report confidence intervals", replications);
+    cmd.AddValue ("jobs", "Replications run at the same time", jobs);
+    cmd.AddValue ("metricsFile", "Write per-flow goodput, drops, retransmissions and cwnd statistics to this file", metricsFile);
+    cmd.AddValue ("flowMonitor", "Write per-flow throughput series, delay/jitter histograms and fairness from FlowMonitor", flowMonitor);
+    cmd.AddValue ("flowMonitorInterval", "Seconds between FlowMonitor throughput samples", flowMonitorInterval);
+    cmd.AddValue ("profile", "Write wall time per phase, events/s, peak RSS and trace callback time to this JSON file", profile);
+    cmd.AddValue ("dropBucket", "Width in seconds of the drop histogram buckets", dropBucket);
+    cmd.AddValue ("dropTrace", "Also write every drop to <tcp>_drops.bin", dropTrace);
+    cmd.AddValue ("cwndTrace", "text (one .cwnd file per flow), binary (one <tcp>_cwnd.bin, see CwndTraceToText) or bins (per-bin summaries in <tcp>_cwnd.bins)", cwndTrace);
+    cmd.AddValue ("binWidth", "Seconds per bin of --cwndTrace=bins", binWidth);
     cmd.Parse(argc,argv);
 
     std::string tcp_type = "ns3::" + tcp_t;
     std::cout<<tcp_type<<endl;
     Config::SetDefault("ns3::TcpL4Protocol::SocketType",StringValue(tcp_type));
+    Config::SetDefault("ns3::TcpNewRenoPlus::Pacing",BooleanValue(pacing));
+    Config::SetDefault("ns3::TcpSocketState::PacingSsRatio",UintegerValue(pacingSsRatio));
+    Config::SetDefault("ns3::TcpSocketState::PacingCaRatio",UintegerValue(pacingCaRatio));
+    Config::SetDefault("ns3::TcpNewRenoPlus::DelayBasedCa",BooleanValue(delayCa));
+    if (!recovery.empty ()){
+        Config::SetDefault("ns3::TcpL4Protocol::RecoveryType",TypeIdValue(TypeId::LookupByName("ns3::" + recovery)));
+    }
+    if (ecn){
+        Config::SetDefault("ns3::TcpSocketBase::UseEcn",StringValue("On"));
+    }
+    map<string, string> queueDiscs = {{"none", ""}, {"FqCoDel", "ns3::FqCoDelQueueDisc"},
+                                      {"PIE", "ns3::PieQueueDisc"}, {"RED", "ns3::RedQueueDisc"}};
+    NS_ABORT_MSG_IF (queueDiscs.find (aqm) == queueDiscs.end (), "Unknown AQM " << aqm);
+    NS_ABORT_MSG_IF (ecn && aqm == "none", "--ecn needs an AQM to mark packets, see --aqm");
+    string prefix = pacing ? tcp_t + "_Pacing" : tcp_t;
+    if (delayCa){
+        prefix += "_DelayCa";
+    }
+    if (!recovery.empty ()){
+        prefix += "_" + recovery;
+    }
+    if (aqm != "none"){
+        prefix += "_" + aqm;
+    }
+    if (ecn){
+        prefix += "_Ecn";
+    }
+
+    if (replications > 1){
+        return RunReplications (argc, argv, replications, max<uint32_t> (jobs, 1), prefix);
+    }
+
+    if (!profile.empty ()){
+        SimProfiler::Enable ();
+    }
+    SimProfiler::Phase ("setup");
+
+    //The long fat network needs scaled windows, buffers that hold them and
+    //a sender that always has data
+    bool lfn = topology == "lfn";
+    //The error rate is per byte, so the default loses ~1.5% of 1448-byte
+    //segments, far too many for any window to fill a long fat network
+    if (errorRate < 0){
+        errorRate = lfn ? 0 : 0.00001;
+    }
+    double bdp = DataRate (bottleneckRate).GetBitRate () * Time (rtt).GetSeconds () / 8;
+    if (lfn){
+        uint32_t segmentSize = 1448;
+        uint32_t buffer = static_cast<uint32_t> (min (2 * bdp, 4e9));
+        Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (segmentSize));
+        Config::SetDefault ("ns3::TcpSocket::SndBufSize", UintegerValue (buffer));
+        Config::SetDefault ("ns3::TcpSocket::RcvBufSize", UintegerValue (buffer));
+        Config::SetDefault ("ns3::TcpSocketBase::WindowScaling", BooleanValue (true));
+        Config::SetDefault ("ns3::TcpSocketBase::Sack", BooleanValue (true));
+        if (queueSize.empty ()){
+            queueSize = to_string (max (static_cast<uint64_t> (bdp / segmentSize), static_cast<uint64_t> (1))) + "p";
+        }
+        packetSize = segmentSize;
+        nPackets = numeric_limits<uint32_t>::max ();
+        bulk = true;
+        nSenders = 1;
+        cout<<"BDP "<<bdp<<" bytes, buffer "<<queueSize<<", socket buffers "<<buffer<<" bytes"<<endl;
+    }
+
+    vector<FlowSpec> flows;
+    if (!flowsFile.empty ()){
+        flows = ReadFlowsFile (flowsFile);
+    }
+    else if (nFlows > 0){
+        for (uint32_t i = 0; i < nFlows; i++){
+            double start = flowStart + i * flowSpacing;
+            flows.push_back ({"F" + to_string (i), i % nSenders, start, min (start + flowDuration, simTime), appRate});
+        }
+    }
+    else if (lfn){
+        flows.push_back ({"LFN", 0, flowStart, simTime, bottleneckRate});
+    }
+    else{
+        flows.push_back ({"N1_1", 0, 1.0, 20.0, "1.5Mbps"});
+        flows.push_back ({"N1_2", 0, 5.0, 25.0, "1.5Mbps"});
+        flows.push_back ({"N2", 1, 15.0, 30.0, "1.5Mbps"});
+    }
+    NS_ABORT_MSG_IF (flows.size () > 65535 - 8000, "Too many flows for one port each");
+    for (const FlowSpec &f : flows){
+        NS_ABORT_MSG_UNLESS (f.sender < nSenders, "Flow " << f.label << " uses sender " << f.sender << " of " << nSenders);
+    }
+
+    NodeContainer senders;
+    senders.Create (nSenders);
+    NodeContainer routers;
+    NodeContainer receivers;
 
-    NodeContainer nodes;
-    nodes.Create (3);
-    NodeContainer nodes13 = NodeContainer (nodes.Get (0), nodes.Get (2));
-    NodeContainer nodes23 = NodeContainer (nodes.Get (1), nodes.Get (2));
-
-    InternetStackHelper internet;
-    internet.Install (nodes);
-
-    PointToPointHelper pointToPoint1;
-    pointToPoint1.SetDeviceAttribute ("DataRate", StringValue("10Mbps"));
-    pointToPoint1.SetChannelAttribute ("Delay", StringValue ("3ms"));
-    NetDeviceContainer device13 = pointToPoint1.Install (nodes13);
+    Ptr<RateErrorModel> em = CreateObject<RateErrorModel> ();
+    em->SetAttribute ("ErrorRate", DoubleValue (errorRate));
 
-    PointToPointHelper pointToPoint2;
-    pointToPoint2.SetDeviceAttribute ("DataRate", StringValue("9Mbps"));
-    pointToPoint2.SetChannelAttribute ("Delay", StringValue ("3ms"));
-    NetDeviceContainer device23 = pointToPoint2.Install (nodes23);
+    vector<string> accessRates = SplitList (accessRate);
+    vector<string> accessDelays = SplitList (accessDelay);
+    LinkBuilder links (queueSize, em, queueDiscs[aqm], ecn);
+    vector<Ptr<Node> > sinkNode (nSenders);
+    vector<Ipv4Address> sinkAddress (nSenders);
 
+    InternetStackHelper internet;
+    if (topology == "star"){
+        receivers.Create (1);
+        internet.Install (senders);
+        internet.Install (receivers);
+        for (uint32_t i = 0; i < nSenders; i++){
+            Ipv4InterfaceContainer ifs = links.Link (senders.Get (i), receivers.Get (0),
+                                                     accessRates[i % accessRates.size ()], accessDelays[i % accessDelays.size ()]);
+            sinkNode[i] = receivers.Get (0);
+            sinkAddress[i] = ifs.GetAddress (1);
+        }
+    }
+    else if (topology == "dumbbell"){
+        routers.Create (2);
+        receivers.Create (nSenders);
+        internet.Install (senders);
+        internet.Install (routers);
+        internet.Install (receivers);
+        links.Link (routers.Get (0), routers.Get (1), bottleneckRate, bottleneckDelay);
+        for (uint32_t i = 0; i < nSenders; i++){
+            string rate = accessRates[i % accessRates.size ()];
+            string delay = accessDelays[i % accessDelays.size ()];
+            links.Link (senders.Get (i), routers.Get (0), rate, delay);
+            Ipv4InterfaceContainer ifs = links.Link (routers.Get (1), receivers.Get (i), rate, delay);
+            sinkNode[i] = receivers.Get (i);
+            sinkAddress[i] = ifs.GetAddress (1);
+        }
+    }
+    else if (topology == "lfn"){
+        receivers.Create (1);
+        internet.Install (senders);
+        internet.Install (receivers);
+        Ipv4InterfaceContainer ifs = links.Link (senders.Get (0), receivers.Get (0),
+                                                 bottleneckRate, to_string (Time (rtt).GetMicroSeconds () / 2) + "us");
+        sinkNode[0] = receivers.Get (0);
+        sinkAddress[0] = ifs.GetAddress (1);
+    }
+    else if (topology == "parkinglot"){
+        NS_ABORT_MSG_UNLESS (hops > 0, "The parking lot needs at least one hop");
+        routers.Create (hops + 1);
+        receivers.Create (1);
+        internet.Install (senders);
+        internet.Install (routers);
+        internet.Install (receivers);
+        for (uint32_t h = 0; h < hops; h++){
+            links.Link (routers.Get (h), routers.Get (h + 1), bottleneckRate, bottleneckDelay);
+        }
+        Ipv4InterfaceContainer ifs = links.Link (routers.Get (hops), receivers.Get (0),
+                                                 accessRates[0], accessDelays[0]);
+        for (uint32_t i = 0; i < nSenders; i++){
+            links.Link (senders.Get (i), routers.Get (i % hops),
+                        accessRates[i % accessRates.size ()], accessDelays[i % accessDelays.size ()]);
+            sinkNode[i] = receivers.Get (0);
+            sinkAddress[i] = ifs.GetAddress (1);
+        }
+    }
+    else{
+        NS_ABORT_MSG ("Unknown topology " << topology);
+    }
 
-    Ptr<RateErrorModel> em = CreateObject<RateErrorModel> ();
-    em->SetAttribute ("ErrorRate", DoubleValue (0.00001));
-    device13.Get (1)->SetAttribute ("ReceiveErrorModel", PointerValue (em));
-    device23.Get (1)->SetAttribute ("ReceiveErrorModel", PointerValue (em));
+    SimProfiler::Phase ("routing");
+    Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+    SimProfiler::Phase ("apps");
 
-    Ipv4AddressHelper ipv4;
-    ipv4.SetBase ("10.10.1.0", "255.255.255.0");
-    Ipv4InterfaceContainer interface13 = ipv4.Assign (device13);
-    ipv4.SetBase ("10.10.2.0", "255.255.255.0");
-    Ipv4InterfaceContainer interface23 = ipv4.Assign (device23);
+    DropStats drops (dropBucket, simTime);
+    if (dropTrace){
+        drops.EnableBinary (prefix + "_drops.bin");
+    }
+    for (uint32_t i = 0; i < links.m_downstream.size (); i++){
+        drops.AddDevice (links.m_downstream[i], "link" + to_string (i));
+    }
 
-    Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+    //One sink, socket and MyApp per flow; flow i uses port 8000 + i
+    AsciiTraceHelper asciiTraceHelper;
+    unique_ptr<CwndTraceWriter> cwndWriter;
+    unique_ptr<CwndBinner> cwndBinner;
+    NS_ABORT_MSG_UNLESS (cwndTrace == "text" || cwndTrace == "binary" || cwndTrace == "bins", "Unknown cwnd trace format " << cwndTrace);
+    //No file at all when no flow is traced
+    if (cwndTrace == "binary" && traceFlows > 0){
+        cwndWriter.reset (new CwndTraceWriter (prefix + "_cwnd.bin"));
+    }
+    else if (cwndTrace == "bins" && traceFlows > 0){
+        NS_ABORT_MSG_UNLESS (binWidth > 0, "The bin width must be positive");
+        cwndBinner.reset (new CwndBinner (prefix + "_cwnd.bins", binWidth));
+    }
+    vector<ApplicationContainer> sinks;
+    vector<Ptr<MyApp> > clientApps;
+    vector<Ptr<Socket> > clientSockets;
+    vector<uint32_t> rwndMax (flows.size (), 0);
+    vector<FlowMetrics> metrics (flows.size (), FlowMetrics {0, SequenceNumber32 (0), false, 0, 0, 0.0, -1.0, 0.0});
+    for (uint32_t i = 0; i < flows.size (); i++){
+        const FlowSpec &f = flows[i];
+        uint16_t port = 8000 + i;
+        drops.AddFlow (f.label, port);
+
+        //Set up TCP server connection
+        Address sinkLocalAddress (InetSocketAddress (Ipv4Address::GetAny (), port));
+        PacketSinkHelper sinkHelper ("ns3::TcpSocketFactory", sinkLocalAddress);
+        ApplicationContainer sinkApp = sinkHelper.Install (sinkNode[f.sender]);
+        sinkApp.Start (Seconds (0.5));
+        sinkApp.Stop (Seconds (simTime + 0.5));
+        sinks.push_back (sinkApp);
+
+        //Create the socket and bind it with application and connect to server
+        Ptr<Socket> ns3TcpSocket = Socket::CreateSocket (senders.Get (f.sender), TcpSocketFactory::GetTypeId ());
+        Ptr<MyApp> clientApp = CreateObject<MyApp> ();
+        Address remoteAddress (InetSocketAddress (sinkAddress[f.sender], port));
+        clientApp->Setup (ns3TcpSocket, remoteAddress, packetSize, nPackets, DataRate (f.rate), batch, bulk);
+        clientApps.push_back (clientApp);
+        clientSockets.push_back (ns3TcpSocket);
+        if (lfn){
+            ns3TcpSocket->TraceConnectWithoutContext ("RWND", MakeBoundCallback (&RwndMax, &rwndMax[i]));
+        }
 
-    //Set up TCP server connection
-    uint16_t port1 = 8000;
-    ApplicationContainer sinkApp;
-    Address sinkLocalAddress(InetSocketAddress (Ipv4Address::GetAny (), port1));
-    PacketSinkHelper sinkHelper ("ns3::TcpSocketFactory", sinkLocalAddress);
-
-    sinkApp.Add(sinkHelper.Install(nodes13.Get(1)));
-    sinkApp.Start (Seconds (0.5));
-    sinkApp.Stop (Seconds (30.5));
-
-    uint16_t port2 = 8001;
-    ApplicationContainer sinkApp1;
-    Address sinkLocalAddress1(InetSocketAddress (Ipv4Address::GetAny (), port2));
-    PacketSinkHelper sinkHelper1 ("ns3::TcpSocketFactory", sinkLocalAddress1);
-
-    sinkApp1.Add(sinkHelper1.Install(nodes13.Get(1)));
-    sinkApp1.Start (Seconds (0.5));
-    sinkApp1.Stop (Seconds (30.5));
-
-    uint16_t port3 = 8002;
-    ApplicationContainer sinkApp2;
-    Address sinkLocalAddress2(InetSocketAddress (Ipv4Address::GetAny (), port3));
-    PacketSinkHelper sinkHelper2 ("ns3::TcpSocketFactory", sinkLocalAddress2);
-
-    sinkApp2.Add(sinkHelper2.Install(nodes23.Get(1)));
-    sinkApp2.Start (Seconds (0.5));
-    sinkApp2.Stop (Seconds (30.5));
-
-    //Create the socket and connect the Trace source
-    Ptr<Socket> ns3TcpSocket1 = Socket::CreateSocket (nodes.Get (0), TcpSocketFactory::GetTypeId ());
-    Ptr<Socket> ns3TcpSocket2 = Socket::CreateSocket (nodes.Get (0), TcpSocketFactory::GetTypeId ());
-    Ptr<Socket> ns3TcpSocket3 = Socket::CreateSocket (nodes.Get (1), TcpSocketFactory::GetTypeId ());
-
-    //Create object of MyApp
-    Ptr<MyApp> clientApp1 = CreateObject<MyApp>();
-    Ptr<MyApp> clientApp2 = CreateObject<MyApp>();
-    Ptr<MyApp> clientApp3 = CreateObject<MyApp>();
-
-    //Make connections
-    Ipv4Address serverAddress1 = interface13.GetAddress (1);
-    Address remoteAddress1 (InetSocketAddress (serverAddress1, port1));
-
-    Ipv4Address serverAddress2 = interface13.GetAddress (1);
-    Address remoteAddress2 (InetSocketAddress (serverAddress2, port2));
-
-    Ipv4Address serverAddress3 = interface23.GetAddress (1);
-    Address remoteAddress3 (InetSocketAddress (serverAddress3, port3));
-
-    //Bind socket with application and connect to server
-    clientApp1->Setup(ns3TcpSocket1, remoteAddress1, packetSize, nPackets, DataRate("1.5Mbps"));
-    clientApp2->Setup(ns3TcpSocket2, remoteAddress2, packetSize, nPackets, DataRate("1.5Mbps"));
-    clientApp3->Setup(ns3TcpSocket3, remoteAddress3, packetSize, nPackets, DataRate("1.5Mbps"));
-
-    //Install application to Client
-    nodes.Get (0)->AddApplication(clientApp1);
-    nodes.Get (0)->AddApplication(clientApp2);
-    nodes.Get (1)->AddApplication(clientApp3);
-
-    //Set start and stop time
-    clientApp1->SetStartTime(Seconds(1.0));
-    clientApp1->SetStopTime(Seconds(20.0));
-    clientApp2->SetStartTime(Seconds(5.0));
-    clientApp2->SetStopTime(Seconds(25.0));
-    clientApp3->SetStartTime(Seconds(15.0));
-    clientApp3->SetStopTime(Seconds(30.0));
+        if (!metricsFile.empty ()){
+            ns3TcpSocket->TraceConnectWithoutContext ("Tx", MakeBoundCallback (&TxMetrics, &metrics[i]));
+            ns3TcpSocket->TraceConnectWithoutContext ("CongestionWindow", MakeBoundCallback (&CwndMetrics, &metrics[i]));
+        }
+        senders.Get (f.sender)->AddApplication (clientApp);
+        clientApp->SetStartTime (Seconds (f.start));
+        clientApp->SetStopTime (Seconds (f.stop));
+
+        if (i < traceFlows && cwndWriter){
+            uint32_t id = cwndWriter->AddFlow (f.label);
+            ns3TcpSocket->TraceConnectWithoutContext ("CongestionWindow", MakeBoundCallback (&CwndChangeBinary, cwndWriter.get (), id));
+            ns3TcpSocket->TraceConnectWithoutContext ("SlowStartThreshold", MakeBoundCallback (&SsThreshChange, cwndWriter.get (), id));
+            ns3TcpSocket->TraceConnectWithoutContext ("CongState", MakeBoundCallback (&CongStateChange, cwndWriter.get (), id));
+        }
+        else if (i < traceFlows && cwndBinner){
+            uint32_t id = cwndBinner->AddFlow (f.label);
+            ns3TcpSocket->TraceConnectWithoutContext ("CongestionWindow", MakeBoundCallback (&CwndBin, cwndBinner.get (), id));
+            ns3TcpSocket->TraceConnectWithoutContext ("SlowStartThreshold", MakeBoundCallback (&SsThreshBin, cwndBinner.get (), id));
+            ns3TcpSocket->TraceConnectWithoutContext ("RTT", MakeBoundCallback (&RttBin, cwndBinner.get (), id));
+            ns3TcpSocket->TraceConnectWithoutContext ("BytesInFlight", MakeBoundCallback (&InFlightBin, cwndBinner.get (), id));
+        }
+        else if (i < traceFlows){
+            Ptr<OutputStreamWrapper> stream = asciiTraceHelper.CreateFileStream (prefix + "_" + f.label + "_Source.cwnd");
+            ns3TcpSocket->TraceConnectWithoutContext ("CongestionWindow", MakeBoundCallback (&CwndChange, stream));
+        }
+    }
 
     // pcap enable
     // pointToPoint.EnablePcapAll ("task1");
 
-    string wnd_file1 = tcp_t + "_N1_1_Source.cwnd";
-    string wnd_file2 = tcp_t + "_N1_2_Source.cwnd";
-    string wnd_file3 = tcp_t + "_N2_Source.cwnd";
-    AsciiTraceHelper asciiTraceHelper;
-    Ptr<OutputStreamWrapper> stream1 = asciiTraceHelper.CreateFileStream (wnd_file1);
-    Ptr<OutputStreamWrapper> stream2 = asciiTraceHelper.CreateFileStream (wnd_file2);
-    Ptr<OutputStreamWrapper> stream3 = asciiTraceHelper.CreateFileStream (wnd_file3);
-    ns3TcpSocket1->TraceConnectWithoutContext ("CongestionWindow", MakeBoundCallback (&CwndChange, stream1));
-    ns3TcpSocket2->TraceConnectWithoutContext ("CongestionWindow", MakeBoundCallback (&CwndChange, stream2));
-    ns3TcpSocket3->TraceConnectWithoutContext ("CongestionWindow", MakeBoundCallback (&CwndChange, stream3));
-
-    device13.Get (1)->TraceConnectWithoutContext ("PhyRxDrop", MakeCallback (&RxDrop));
-    device23.Get (1)->TraceConnectWithoutContext ("PhyRxDrop", MakeCallback (&RxDrop));
+    FlowMonitorHelper flowmonHelper;
+    unique_ptr<FlowReport> flowReport;
+    if (flowMonitor){
+        Ptr<FlowMonitor> monitor = flowmonHelper.InstallAll ();
+        flowReport.reset (new FlowReport (monitor, DynamicCast<Ipv4FlowClassifier> (flowmonHelper.GetClassifier ()), flowMonitorInterval));
+        // Flows share the bottleneck (in the parking lot, every flow crosses its
+        // last hop); only the star has nothing shared beyond each access link
+        for (uint32_t i = 0; i < flows.size (); i++){
+            uint32_t sender = flows[i].sender;
+            if (topology == "star"){
+                string rate = accessRates[sender % accessRates.size ()];
+                flowReport->AddFlow (flows[i].label, 8000 + i, flows[i].start, flows[i].stop,
+                                     "sender" + to_string (sender), DataRate (rate).GetBitRate ());
+            }
+            else{
+                flowReport->AddFlow (flows[i].label, 8000 + i, flows[i].start, flows[i].stop,
+                                     "bottleneck", DataRate (bottleneckRate).GetBitRate ());
+            }
+        }
+        flowReport->Start ();
+    }
+
+    UtilMonitor util {vector<Ptr<PacketSink> > (), static_cast<double> (DataRate (bottleneckRate).GetBitRate ()),
+                      utilInterval, utilTarget, flows.empty () ? 0.0 : flows[0].start, 0, -1.0, 0.0};
+    if (lfn){
+        for (ApplicationContainer &sink : sinks){
+            util.sinks.push_back (DynamicCast<PacketSink> (sink.Get (0)));
+        }
+        Simulator::Schedule (Seconds (util.start + utilInterval), &SampleUtilisation, &util);
+    }
 
-    Simulator::Stop (Seconds(30));
+    Simulator::Stop (Seconds(simTime));
+    SimProfiler::Phase ("run");
+    auto runStart = chrono::steady_clock::now ();
+    uint64_t eventsBefore = Simulator::GetEventCount ();
     Simulator::Run ();
-    Simulator::Destroy ();
+    double runWall = chrono::duration<double> (chrono::steady_clock::now () - runStart).count ();
+    SimProfiler::Phase ("report");
+
+    if (lfn){
+        if (util.reached >= 0){
+            cout<<"Time to "<<utilTarget * 100<<"% utilisation: "<<util.reached<<" s"<<endl;
+        }
+        else{
+            //-1 rather than text, so tools reading the number see a miss, not a zero
+            cout<<"Time to "<<utilTarget * 100<<"% utilisation: -1 s (not reached, peak "<<util.peak * 100<<"%)"<<endl;
+        }
+        for (uint32_t i = 0; i < clientSockets.size (); i++){
+            //Both attributes read back what the handshake negotiated
+            BooleanValue windowScaling, sack;
+            clientSockets[i]->GetAttribute ("WindowScaling", windowScaling);
+            clientSockets[i]->GetAttribute ("Sack", sack);
+            cout<<"Flow "<<flows[i].label<<" window scaling: "<<(windowScaling.Get () ? "on" : "off")
+                <<" SACK: "<<(sack.Get () ? "on" : "off")<<" peak receive window: "<<rwndMax[i]<<" bytes"<<endl;
+            if (bdp > 65535 && rwndMax[i] <= 65535){
+                cout<<"WARNING: flow "<<flows[i].label<<" never saw a window above 65535 bytes, below the BDP"<<endl;
+            }
+        }
+        cout<<"Events/s: "<<(Simulator::GetEventCount () - eventsBefore) / runWall<<endl;
+    }
+
+    if (flowReport){
+        flowReport->Write (prefix);
+    }
+
+    //Goodput of each flow over its active period
+    for (uint32_t i = 0; i < flows.size (); i++){
+        uint64_t rxBytes = DynamicCast<PacketSink> (sinks[i].Get (0))->GetTotalRx ();
+        double duration = flows[i].stop - flows[i].start;
+        cout<<"Flow "<<flows[i].label<<" goodput: "<<rxBytes * 8 / duration / 1e6<<" Mbps"
+            <<" offered: "<<clientApps[i]->GetBytesSent () * 8 / duration / 1e6<<" Mbps";
+        if (bulk){
+            //Waiting on the socket buffer means the network, not the application, set the pace
+            cout<<" network-limited: "<<clientApps[i]->GetBufferFullTime ().GetSeconds () / duration * 100<<"%"<<endl;
+        }
+        else{
+            cout<<" refused sends: "<<clientApps[i]->GetSendsRefused ()<<endl;
+        }
+    }
+
+    if (!metricsFile.empty ()){
+        ofstream out (metricsFile);
+        for (uint32_t i = 0; i < flows.size (); i++){
+            FlowMetrics &m = metrics[i];
+            double duration = flows[i].stop - flows[i].start;
+            double goodput = DynamicCast<PacketSink> (sinks[i].Get (0))->GetTotalRx () * 8 / duration / 1e6;
+            double end = min (flows[i].stop, simTime);
+            double cwndMean = 0;
+            if (m.firstChange >= 0 && end > m.firstChange){
+                cwndMean = (m.cwndArea + m.cwnd * max (end - m.lastChange, 0.0)) / (end - m.firstChange);
+            }
+            out<<flows[i].label<<" "<<goodput<<" "<<drops.GetFlowDrops (i)<<" "<<m.retransmissions
+               <<" "<<cwndMean<<" "<<m.cwndMax<<"\n";
+        }
+    }
 
-    cout<<"No of packet drop: "<<c<<endl;
-}
\ No newline at end of file
+    SimProfiler::Phase ("teardown");
+    Simulator::Destroy ();
+    if (cwndWriter){
+        cwndWriter->Close ();
+    }
+    if (cwndBinner){
+        cwndBinner->Close ();
+    }
+    SimProfiler::Write (profile);
+
+    cout<<"No of packet drop: "<<drops.GetTotal ()<<endl;
+}
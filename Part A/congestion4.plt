@@ -3,4 +3,12 @@ set output "TcpNewRenoPlus_congestion_N1_1.png"
 set title "TcpNewRenoPlus Congestion Window N1 1"
 set xlabel "Time (in Seconds)"
 set ylabel "Congestion Window (cwnd)"
-plot "TcpNewRenoPlus_N1_1_Source.cwnd" using 1:3 with linespoint title "Congestion Window"
+# gnuplot -e "bins=1" plots the per-bin summary of First --cwndTrace=bins instead;
+# otherwise the newer of the .cwndc store and the .cwnd text trace is plotted
+if (exists("bins")) {
+    plot "< grep '^N1_1 ' TcpNewRenoPlus_cwnd.bins" using 2:3:5 with filledcurves title "cwnd min/max per bin", "" using 2:4 with lines title "cwnd mean"
+} else if (system("test TcpNewRenoPlus_cwnd.cwndc -nt TcpNewRenoPlus_N1_1_Source.cwnd && echo 1") eq "1") {
+    plot "< ./build/scratch/CwndStore extract TcpNewRenoPlus_cwnd.cwndc N1_1 0 30 2000" using 1:3 with linespoint title "Congestion Window"
+} else {
+    plot "TcpNewRenoPlus_N1_1_Source.cwnd" using 1:3 with linespoint title "Congestion Window"
+}
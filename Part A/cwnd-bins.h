@@ -0,0 +1,160 @@
+#ifndef CWND_BINS_H
+#define CWND_BINS_H
+
+/*
+  Streaming per-bin summary of the congestion state of every flow, written
+  by First with --cwndTrace=bins instead of one line per cwnd change.
+
+  Each flow keeps running min, max and time-weighted mean of cwnd,
+  ssthresh, RTT and bytes in flight for the bin of the current time only
+  (O(1) per trace event). When an event falls in a later bin the finished
+  bin is written as one line:
+
+    label binStart  cwnd min mean max  ssthresh min mean max
+                    rtt(ms) min mean max  inflight min mean max
+
+  Bins in which nothing changed are skipped; the values held from the last
+  written bin. A quantity not yet traced is written as nan. gnuplot reads
+  one flow with
+    plot "< grep '^N1_1 ' TcpNewReno_cwnd.bins" using 2:3:5 with filledcurves, "" using 2:4 with lines
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+class CwndBinner{
+
+        public:
+                enum Quantity{
+                        CWND,
+                        SSTHRESH,
+                        RTT,
+                        INFLIGHT,
+                        N_QUANTITIES
+                };
+
+                CwndBinner (std::string fileName, double binWidth);
+                ~CwndBinner ();
+
+                //Registers a flow and returns its id
+                uint32_t AddFlow (std::string label);
+
+                void Update (uint32_t flow, Quantity q, double time, double value);
+
+                //Writes the open bin of every flow; called by the destructor
+                void Close (void);
+
+        private:
+                struct Stat{
+                        bool    known;          // traced at least once
+                        double  value;          // held since last
+                        double  last;
+                        double  from;           // start of the part of the bin the mean covers
+                        double  min;
+                        double  max;
+                        double  area;
+                };
+
+                struct Flow{
+                        std::string     label;
+                        int64_t         bin;    // -1 before the first event
+                        Stat            stats[N_QUANTITIES];
+                };
+
+                void Flush (Flow &f);
+
+                std::FILE               *m_file;
+                double                  m_width;
+                std::vector<Flow>       m_flows;
+};
+
+inline CwndBinner::CwndBinner (std::string fileName, double binWidth)
+        : m_file (std::fopen (fileName.c_str (), "w")),
+        m_width (binWidth)
+{
+        if (m_file){
+                std::fprintf (m_file, "# label binStart cwnd(min mean max) ssthresh(min mean max) rtt_ms(min mean max) inflight(min mean max), bin %g s\n", m_width);
+        }
+}
+
+inline CwndBinner::~CwndBinner (){
+        Close ();
+}
+
+inline uint32_t CwndBinner::AddFlow (std::string label){
+        Flow f;
+        f.label = label;
+        f.bin = -1;
+        for (Stat &s : f.stats){
+                s = Stat {false, 0, 0, 0, 0, 0, 0};
+        }
+        m_flows.push_back (f);
+        return m_flows.size () - 1;
+}
+
+inline void CwndBinner::Update (uint32_t flow, Quantity q, double time, double value){
+        Flow &f = m_flows[flow];
+        int64_t bin = static_cast<int64_t> (time / m_width);
+        if (bin != f.bin){
+                if (f.bin >= 0){
+                        Flush (f);
+                }
+                //A new bin starts from the values held over the gap
+                f.bin = bin;
+                for (Stat &s : f.stats){
+                        s.last = s.from = bin * m_width;
+                        s.min = s.max = s.value;
+                        s.area = 0;
+                }
+        }
+        Stat &s = f.stats[q];
+        if (s.known){
+                s.area += s.value * (time - s.last);
+        }
+        else{
+                s.known = true;
+                s.from = time;
+                s.min = s.max = value;
+        }
+        s.value = value;
+        s.last = time;
+        s.min = std::min (s.min, value);
+        s.max = std::max (s.max, value);
+}
+
+inline void CwndBinner::Flush (Flow &f){
+        if (!m_file){
+                return;
+        }
+        double end = (f.bin + 1) * m_width;
+        std::fprintf (m_file, "%s %.6f", f.label.c_str (), f.bin * m_width);
+        for (const Stat &s : f.stats){
+                if (!s.known){
+                        std::fprintf (m_file, " nan nan nan");
+                        continue;
+                }
+                double covered = end - s.from;
+                double mean = covered > 0 ? (s.area + s.value * (end - s.last)) / covered : s.value;
+                std::fprintf (m_file, " %.6g %.6g %.6g", s.min, mean, s.max);
+        }
+        std::fputc ('\n', m_file);
+}
+
+inline void CwndBinner::Close (void){
+        if (!m_file){
+                return;
+        }
+        for (Flow &f : m_flows){
+                if (f.bin >= 0){
+                        Flush (f);
+                }
+        }
+        std::fclose (m_file);
+        m_file = 0;
+}
+
+#endif // CWND_BINS_H
@@ -0,0 +1,369 @@
+#ifndef CWND_STORE_H
+#define CWND_STORE_H
+
+/*
+  Columnar cwnd store built from a binary cwnd trace (cwnd-trace.h).
+
+  Records are grouped by flow and sorted by time within a flow. Each field
+  is its own column, and every indexStride-th time is copied into a small
+  sparse index, so a time window of one flow is found by a binary search
+  over the index plus a scan of at most indexStride records. The reader
+  memory-maps the file and only touches the pages of the window it reads.
+
+  File layout (all sections 8-byte aligned):
+    CwndStoreHeader
+    time column     double   * nRecords
+    cwnd column     uint32_t * nRecords
+    flow column     uint32_t * nRecords
+    flow extents    CwndStoreExtent * nFlows
+    sparse index    double   * nIndex
+    flow labels, each as uint32_t length + bytes
+*/
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "cwnd-trace.h"
+
+static const uint32_t CWND_STORE_MAGIC = 0x434e5743;   // "CWNC"
+static const uint32_t CWND_STORE_VERSION = 1;
+
+struct CwndStoreHeader{
+        uint32_t magic;
+        uint32_t version;
+        uint64_t nRecords;
+        uint32_t nFlows;
+        uint32_t indexStride;
+        uint64_t nIndex;
+        uint64_t timeOffset;
+        uint64_t cwndOffset;
+        uint64_t flowOffset;
+        uint64_t extentOffset;
+        uint64_t indexOffset;
+        uint64_t labelsOffset;
+        uint64_t fileSize;
+};
+
+struct CwndStoreExtent{
+        uint64_t begin;
+        uint64_t end;
+};
+
+struct CwndPoint{
+        double   time;
+        uint32_t cwnd;
+};
+
+inline uint64_t CwndStoreAlign (uint64_t offset){
+        return (offset + 7) & ~static_cast<uint64_t> (7);
+}
+
+//Builds storeFile from the binary trace traceFile; returns an empty string or the error
+inline std::string BuildCwndStore (std::string traceFile, std::string storeFile, uint32_t indexStride = 256){
+        FILE *in = std::fopen (traceFile.c_str (), "rb");
+        if (!in){
+                return "cannot open " + traceFile;
+        }
+        CwndTraceHeader th;
+        CwndTraceFooter tf;
+        if (std::fread (&th, sizeof (th), 1, in) != 1 || th.magic != CWND_TRACE_MAGIC
+            || th.version != CWND_TRACE_VERSION || th.recordSize != sizeof (CwndRecord)
+            || std::fseek (in, -static_cast<long> (sizeof (tf)), SEEK_END) != 0
+            || std::fread (&tf, sizeof (tf), 1, in) != 1 || tf.magic != CWND_TRACE_MAGIC){
+                std::fclose (in);
+                return traceFile + " is not a complete cwnd trace";
+        }
+        uint64_t nRecords = (tf.labelsOffset - sizeof (th)) / sizeof (CwndRecord);
+
+        //Labels are copied as they are
+        std::fseek (in, 0, SEEK_END);
+        long labelsSize = std::ftell (in) - static_cast<long> (tf.labelsOffset) - static_cast<long> (sizeof (tf));
+        std::vector<char> labels (std::max<long> (labelsSize, 0));
+        std::fseek (in, tf.labelsOffset, SEEK_SET);
+        if (labelsSize > 0 && std::fread (labels.data (), 1, labelsSize, in) != static_cast<size_t> (labelsSize)){
+                std::fclose (in);
+                return traceFile + " is truncated";
+        }
+
+        //First pass: records per flow
+        std::vector<CwndRecord> block (1 << 16);
+        std::vector<CwndStoreExtent> extents (tf.nFlows, CwndStoreExtent {0, 0});
+        std::fseek (in, sizeof (th), SEEK_SET);
+        for (uint64_t remaining = nRecords; remaining > 0; ){
+                size_t n = std::fread (block.data (), sizeof (CwndRecord), std::min<uint64_t> (remaining, block.size ()), in);
+                if (n == 0){
+                        std::fclose (in);
+                        return traceFile + " is truncated";
+                }
+                for (size_t i = 0; i < n; i++){
+                        if (block[i].flow < tf.nFlows){
+                                extents[block[i].flow].end++;
+                        }
+                }
+                remaining -= n;
+        }
+        uint64_t stored = 0;
+        std::vector<uint64_t> limits;
+        for (CwndStoreExtent &e : extents){
+                e.begin = stored;
+                stored += e.end;
+                e.end = e.begin;
+                limits.push_back (stored);
+        }
+
+        CwndStoreHeader h;
+        std::memset (&h, 0, sizeof (h));
+        h.magic = CWND_STORE_MAGIC;
+        h.version = CWND_STORE_VERSION;
+        h.nRecords = stored;
+        h.nFlows = tf.nFlows;
+        h.indexStride = std::max<uint32_t> (indexStride, 1);
+        h.nIndex = (stored + h.indexStride - 1) / h.indexStride;
+        h.timeOffset = CwndStoreAlign (sizeof (h));
+        h.cwndOffset = CwndStoreAlign (h.timeOffset + stored * sizeof (double));
+        h.flowOffset = CwndStoreAlign (h.cwndOffset + stored * sizeof (uint32_t));
+        h.extentOffset = CwndStoreAlign (h.flowOffset + stored * sizeof (uint32_t));
+        h.indexOffset = CwndStoreAlign (h.extentOffset + h.nFlows * sizeof (CwndStoreExtent));
+        h.labelsOffset = CwndStoreAlign (h.indexOffset + h.nIndex * sizeof (double));
+        h.fileSize = h.labelsOffset + labels.size ();
+
+        int fd = open (storeFile.c_str (), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0 || ftruncate (fd, h.fileSize) != 0){
+                if (fd >= 0){
+                        close (fd);
+                }
+                std::fclose (in);
+                return "cannot create " + storeFile;
+        }
+        char *base = static_cast<char *> (mmap (0, h.fileSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0));
+        close (fd);
+        if (base == MAP_FAILED){
+                std::fclose (in);
+                return "cannot map " + storeFile;
+        }
+        double *time = reinterpret_cast<double *> (base + h.timeOffset);
+        uint32_t *cwnd = reinterpret_cast<uint32_t *> (base + h.cwndOffset);
+        uint32_t *flow = reinterpret_cast<uint32_t *> (base + h.flowOffset);
+
+        //Second pass: the trace is in time order, so appending keeps every flow sorted.
+        //A trace shortened or rewritten since the first pass must not run past the extents.
+        std::fseek (in, sizeof (th), SEEK_SET);
+        for (uint64_t remaining = nRecords; remaining > 0; ){
+                size_t n = std::fread (block.data (), sizeof (CwndRecord), std::min<uint64_t> (remaining, block.size ()), in);
+                if (n == 0){
+                        munmap (base, h.fileSize);
+                        std::fclose (in);
+                        unlink (storeFile.c_str ());
+                        return traceFile + " is truncated";
+                }
+                for (size_t i = 0; i < n; i++){
+                        const CwndRecord &r = block[i];
+                        if (r.flow < tf.nFlows){
+                                if (extents[r.flow].end == limits[r.flow]){
+                                        munmap (base, h.fileSize);
+                                        std::fclose (in);
+                                        unlink (storeFile.c_str ());
+                                        return traceFile + " changed while it was read";
+                                }
+                                uint64_t pos = extents[r.flow].end++;
+                                time[pos] = r.time;
+                                cwnd[pos] = r.newCwnd;
+                                flow[pos] = r.flow;
+                        }
+                }
+                remaining -= n;
+        }
+        std::fclose (in);
+
+        double *index = reinterpret_cast<double *> (base + h.indexOffset);
+        for (uint64_t j = 0; j < h.nIndex; j++){
+                index[j] = time[j * h.indexStride];
+        }
+        std::memcpy (base + h.extentOffset, extents.data (), extents.size () * sizeof (CwndStoreExtent));
+        std::memcpy (base + h.labelsOffset, labels.data (), labels.size ());
+        std::memcpy (base, &h, sizeof (h));
+        munmap (base, h.fileSize);
+        return "";
+}
+
+//Read-only, memory-mapped view of a cwnd store
+class CwndStoreReader{
+
+        public:
+                CwndStoreReader ();
+                ~CwndStoreReader ();
+
+                //Returns an empty string or the error
+                std::string Open (std::string storeFile);
+
+                uint32_t FlowCount (void) const;
+                std::string FlowLabel (uint32_t flow) const;
+                //Returns the flow id of label, or FlowCount () if there is none
+                uint32_t FindFlow (std::string label) const;
+
+                //Record positions [first, last) of flow with t0 <= time <= t1
+                std::pair<uint64_t, uint64_t> Range (uint32_t flow, double t0, double t1) const;
+                double Time (uint64_t pos) const;
+                uint32_t Cwnd (uint64_t pos) const;
+
+                //At most maxPoints points of flow in [t0, t1], keeping the min and max cwnd of each time bucket
+                std::vector<CwndPoint> Downsample (uint32_t flow, double t0, double t1, uint32_t maxPoints) const;
+
+        private:
+                //First position in [begin, end) of a flow whose time is not before t (after t if strict)
+                uint64_t Seek (uint64_t begin, uint64_t end, double t, bool strict) const;
+
+                char                            *m_base;
+                uint64_t                        m_size;
+                const CwndStoreHeader           *m_header;
+                const double                    *m_time;
+                const uint32_t                  *m_cwnd;
+                const CwndStoreExtent           *m_extents;
+                const double                    *m_index;
+                std::vector<std::string>        m_labels;
+};
+
+inline CwndStoreReader::CwndStoreReader ()
+        : m_base (0),
+        m_size (0),
+        m_header (0),
+        m_time (0),
+        m_cwnd (0),
+        m_extents (0),
+        m_index (0)
+{
+}
+
+inline CwndStoreReader::~CwndStoreReader (){
+        if (m_base){
+                munmap (m_base, m_size);
+        }
+}
+
+inline std::string CwndStoreReader::Open (std::string storeFile){
+        int fd = open (storeFile.c_str (), O_RDONLY);
+        if (fd < 0){
+                return "cannot open " + storeFile;
+        }
+        struct stat st;
+        if (fstat (fd, &st) != 0 || static_cast<uint64_t> (st.st_size) < sizeof (CwndStoreHeader)){
+                close (fd);
+                return storeFile + " is not a cwnd store";
+        }
+        void *base = mmap (0, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        close (fd);
+        if (base == MAP_FAILED){
+                return "cannot map " + storeFile;
+        }
+        m_base = static_cast<char *> (base);
+        m_size = st.st_size;
+        m_header = reinterpret_cast<const CwndStoreHeader *> (m_base);
+        if (m_header->magic != CWND_STORE_MAGIC || m_header->version != CWND_STORE_VERSION
+            || m_header->fileSize != m_size){
+                return storeFile + " is not a cwnd store";
+        }
+        m_time = reinterpret_cast<const double *> (m_base + m_header->timeOffset);
+        m_cwnd = reinterpret_cast<const uint32_t *> (m_base + m_header->cwndOffset);
+        m_extents = reinterpret_cast<const CwndStoreExtent *> (m_base + m_header->extentOffset);
+        m_index = reinterpret_cast<const double *> (m_base + m_header->indexOffset);
+
+        const char *p = m_base + m_header->labelsOffset;
+        for (uint32_t i = 0; i < m_header->nFlows; i++){
+                uint32_t length;
+                std::memcpy (&length, p, sizeof (length));
+                m_labels.push_back (std::string (p + sizeof (length), length));
+                p += sizeof (length) + length;
+        }
+        return "";
+}
+
+inline uint32_t CwndStoreReader::FlowCount (void) const{
+        return m_labels.size ();
+}
+
+inline std::string CwndStoreReader::FlowLabel (uint32_t flow) const{
+        return m_labels[flow];
+}
+
+inline uint32_t CwndStoreReader::FindFlow (std::string label) const{
+        return std::find (m_labels.begin (), m_labels.end (), label) - m_labels.begin ();
+}
+
+inline double CwndStoreReader::Time (uint64_t pos) const{
+        return m_time[pos];
+}
+
+inline uint32_t CwndStoreReader::Cwnd (uint64_t pos) const{
+        return m_cwnd[pos];
+}
+
+inline uint64_t CwndStoreReader::Seek (uint64_t begin, uint64_t end, double t, bool strict) const{
+        if (begin >= end){
+                return end;
+        }
+        //Index entries falling inside [begin, end)
+        uint64_t stride = m_header->indexStride;
+        const double *first = m_index + (begin + stride - 1) / stride;
+        const double *last = m_index + (end - 1) / stride + 1;
+        const double *it = strict ? std::upper_bound (first, last, t) : std::lower_bound (first, last, t);
+        uint64_t pos = (it == first) ? begin : (it - 1 - m_index) * stride;
+        while (pos < end && (strict ? m_time[pos] <= t : m_time[pos] < t)){
+                pos++;
+        }
+        return pos;
+}
+
+inline std::pair<uint64_t, uint64_t> CwndStoreReader::Range (uint32_t flow, double t0, double t1) const{
+        const CwndStoreExtent &e = m_extents[flow];
+        uint64_t first = Seek (e.begin, e.end, t0, false);
+        return std::make_pair (first, Seek (first, e.end, t1, true));
+}
+
+inline std::vector<CwndPoint> CwndStoreReader::Downsample (uint32_t flow, double t0, double t1, uint32_t maxPoints) const{
+        std::vector<CwndPoint> points;
+        std::pair<uint64_t, uint64_t> range = Range (flow, t0, t1);
+        if (range.second - range.first <= maxPoints || maxPoints < 2){
+                for (uint64_t i = range.first; i < range.second; i++){
+                        points.push_back (CwndPoint {m_time[i], m_cwnd[i]});
+                }
+                return points;
+        }
+
+        uint32_t buckets = maxPoints / 2;
+        double start = m_time[range.first];
+        double width = (m_time[range.second - 1] - start) / buckets;
+        uint64_t i = range.first;
+        for (uint32_t b = 0; b < buckets && i < range.second; b++){
+                double bucketEnd = (b + 1 == buckets) ? m_time[range.second - 1] : start + (b + 1) * width;
+                uint64_t minPos = i;
+                uint64_t maxPos = i;
+                for (; i < range.second && (m_time[i] < bucketEnd || b + 1 == buckets); i++){
+                        if (m_cwnd[i] < m_cwnd[minPos]){
+                                minPos = i;
+                        }
+                        if (m_cwnd[i] > m_cwnd[maxPos]){
+                                maxPos = i;
+                        }
+                }
+                if (i == minPos){
+                        continue;       // empty bucket
+                }
+                uint64_t a = std::min (minPos, maxPos);
+                uint64_t c = std::max (minPos, maxPos);
+                points.push_back (CwndPoint {m_time[a], m_cwnd[a]});
+                if (c != a){
+                        points.push_back (CwndPoint {m_time[c], m_cwnd[c]});
+                }
+        }
+        return points;
+}
+
+#endif // CWND_STORE_H
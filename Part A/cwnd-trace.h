@@ -0,0 +1,142 @@
+#ifndef CWND_TRACE_H
+#define CWND_TRACE_H
+
+/*
+  Binary cwnd trace shared by First (writer) and CwndTraceToText (reader).
+
+  File layout:
+    CwndTraceHeader
+    CwndRecord * n
+    flow labels, each as uint32_t length + bytes
+    CwndTraceFooter
+*/
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+static const uint32_t CWND_TRACE_MAGIC = 0x444e5743;   // "CWND"
+static const uint32_t CWND_TRACE_VERSION = 1;
+
+struct CwndTraceHeader{
+        uint32_t magic;
+        uint32_t version;
+        uint32_t recordSize;
+        uint32_t reserved;
+};
+
+struct CwndRecord{
+        double   time;          // seconds
+        uint32_t flow;          // index into the flow labels
+        uint32_t oldCwnd;
+        uint32_t newCwnd;
+        uint32_t ssThresh;
+        uint8_t  state;         // TcpSocketState::TcpCongState_t
+        uint8_t  pad[7];
+};
+
+struct CwndTraceFooter{
+        uint64_t labelsOffset;
+        uint32_t nFlows;
+        uint32_t magic;
+};
+
+//Appends CwndRecords to a large buffer and writes it out in blocks
+class CwndTraceWriter{
+
+        public:
+                CwndTraceWriter (std::string fileName, size_t bufferRecords = 1 << 16);
+                ~CwndTraceWriter ();
+
+                //Registers a flow and returns its id
+                uint32_t AddFlow (std::string label);
+
+                void SetSsThresh (uint32_t flow, uint32_t ssThresh);
+                void SetState (uint32_t flow, uint8_t state);
+                void Append (double time, uint32_t flow, uint32_t oldCwnd, uint32_t newCwnd);
+
+                //Flushes the buffer and writes the labels; called by the destructor
+                void Close (void);
+
+        private:
+                void Flush (void);
+
+                std::FILE               *m_file;
+                std::vector<CwndRecord> m_buffer;
+                size_t                  m_used;
+                uint64_t                m_offset;
+                std::vector<std::string> m_labels;
+                std::vector<uint32_t>   m_ssThresh;
+                std::vector<uint8_t>    m_state;
+};
+
+inline CwndTraceWriter::CwndTraceWriter (std::string fileName, size_t bufferRecords)
+        : m_file (std::fopen (fileName.c_str (), "wb")),
+        m_buffer (bufferRecords),
+        m_used (0),
+        m_offset (sizeof (CwndTraceHeader))
+{
+        if (m_file){
+                CwndTraceHeader header = {CWND_TRACE_MAGIC, CWND_TRACE_VERSION, sizeof (CwndRecord), 0};
+                std::fwrite (&header, sizeof (header), 1, m_file);
+        }
+}
+
+inline CwndTraceWriter::~CwndTraceWriter (){
+        Close ();
+}
+
+inline uint32_t CwndTraceWriter::AddFlow (std::string label){
+        m_labels.push_back (label);
+        m_ssThresh.push_back (UINT32_MAX);
+        m_state.push_back (0);
+        return m_labels.size () - 1;
+}
+
+inline void CwndTraceWriter::SetSsThresh (uint32_t flow, uint32_t ssThresh){
+        m_ssThresh[flow] = ssThresh;
+}
+
+inline void CwndTraceWriter::SetState (uint32_t flow, uint8_t state){
+        m_state[flow] = state;
+}
+
+inline void CwndTraceWriter::Append (double time, uint32_t flow, uint32_t oldCwnd, uint32_t newCwnd){
+        CwndRecord &r = m_buffer[m_used];
+        r.time = time;
+        r.flow = flow;
+        r.oldCwnd = oldCwnd;
+        r.newCwnd = newCwnd;
+        r.ssThresh = m_ssThresh[flow];
+        r.state = m_state[flow];
+        if (++m_used == m_buffer.size ()){
+                Flush ();
+        }
+}
+
+inline void CwndTraceWriter::Flush (void){
+        if (m_file && m_used > 0){
+                std::fwrite (m_buffer.data (), sizeof (CwndRecord), m_used, m_file);
+                m_offset += m_used * sizeof (CwndRecord);
+        }
+        m_used = 0;
+}
+
+inline void CwndTraceWriter::Close (void){
+        if (!m_file){
+                return;
+        }
+        Flush ();
+        for (const std::string &label : m_labels){
+                uint32_t length = label.size ();
+                std::fwrite (&length, sizeof (length), 1, m_file);
+                std::fwrite (label.data (), 1, length, m_file);
+        }
+        CwndTraceFooter footer = {m_offset, static_cast<uint32_t> (m_labels.size ()), CWND_TRACE_MAGIC};
+        std::fwrite (&footer, sizeof (footer), 1, m_file);
+        std::fclose (m_file);
+        m_file = 0;
+}
+
+#endif // CWND_TRACE_H
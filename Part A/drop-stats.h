@@ -0,0 +1,204 @@
+#ifndef DROP_STATS_H
+#define DROP_STATS_H
+
+/*
+  Drop statistics collector attached to the PhyRxDrop trace of devices.
+
+  Keeps per-device and per-flow counters and a fixed-bucket time histogram
+  in memory, prints a summary when the simulator is destroyed and can
+  stream every drop as a fixed-size binary DropRecord, written in blocks.
+  Flows are told apart by TCP port: a packet belongs to the flow whose
+  port is its destination port (data) or source port (ACKs).
+*/
+
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/ppp-header.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/tcp-header.h"
+#include "ns3/tcp-l4-protocol.h"
+#include "sim-profiler.h"
+
+struct DropRecord{
+        double   time;
+        uint32_t device;
+        uint32_t flow;          // DropStats::NO_FLOW if the packet matched no flow
+        uint32_t size;
+        uint32_t pad;
+};
+
+class DropStats{
+
+        public:
+                static const uint32_t NO_FLOW = UINT32_MAX;
+
+                DropStats (double bucketWidth, double simTime);
+                ~DropStats ();
+
+                //Counts the PhyRxDrop events of device
+                void AddDevice (ns3::Ptr<ns3::NetDevice> device, std::string label);
+                void AddFlow (std::string label, uint16_t port);
+                //Streams every drop to fileName as DropRecords
+                void EnableBinary (std::string fileName);
+
+                uint64_t GetTotal (void) const;
+                uint64_t GetFlowDrops (uint32_t flow) const;
+                void PrintSummary (std::ostream &os) const;
+
+        private:
+                static void PhyRxDrop (DropStats *stats, uint32_t device, ns3::Ptr<const ns3::Packet> p);
+                void Drop (uint32_t device, ns3::Ptr<const ns3::Packet> p);
+                uint32_t Classify (ns3::Ptr<const ns3::Packet> p) const;
+                void Flush (void);
+                void Report (void);
+
+                double                                  m_bucketWidth;
+                std::vector<uint64_t>                   m_buckets;
+                std::vector<std::string>                m_deviceLabels;
+                std::vector<uint64_t>                   m_deviceDrops;
+                std::vector<std::string>                m_flowLabels;
+                std::vector<uint64_t>                   m_flowDrops;
+                std::unordered_map<uint16_t, uint32_t>  m_ports;
+                uint64_t                                m_otherDrops;
+                uint64_t                                m_total;
+                std::FILE                               *m_file;
+                std::vector<DropRecord>                 m_buffer;
+                size_t                                  m_used;
+};
+
+inline DropStats::DropStats (double bucketWidth, double simTime)
+        : m_bucketWidth (bucketWidth),
+        m_buckets (static_cast<size_t> (simTime / bucketWidth) + 1, 0),
+        m_otherDrops (0),
+        m_total (0),
+        m_file (0),
+        m_used (0)
+{
+        ns3::Simulator::ScheduleDestroy (&DropStats::Report, this);
+}
+
+inline DropStats::~DropStats (){
+        if (m_file){
+                Flush ();
+                std::fclose (m_file);
+        }
+}
+
+inline void DropStats::AddDevice (ns3::Ptr<ns3::NetDevice> device, std::string label){
+        uint32_t id = m_deviceLabels.size ();
+        m_deviceLabels.push_back (label);
+        m_deviceDrops.push_back (0);
+        device->TraceConnectWithoutContext ("PhyRxDrop", ns3::MakeBoundCallback (&DropStats::PhyRxDrop, this, id));
+}
+
+inline void DropStats::AddFlow (std::string label, uint16_t port){
+        m_ports[port] = m_flowLabels.size ();
+        m_flowLabels.push_back (label);
+        m_flowDrops.push_back (0);
+}
+
+inline void DropStats::EnableBinary (std::string fileName){
+        m_file = std::fopen (fileName.c_str (), "wb");
+        NS_ABORT_MSG_UNLESS (m_file, "Cannot write drop trace " << fileName);
+        m_buffer.resize (1 << 16);
+}
+
+inline uint64_t DropStats::GetTotal (void) const{
+        return m_total;
+}
+
+inline uint64_t DropStats::GetFlowDrops (uint32_t flow) const{
+        return m_flowDrops[flow];
+}
+
+inline void DropStats::PhyRxDrop (DropStats *stats, uint32_t device, ns3::Ptr<const ns3::Packet> p){
+        static const uint32_t profileId = SimProfiler::Register ("RxDrop");
+        SimProfiler::Scope scope (profileId);
+        stats->Drop (device, p);
+}
+
+inline void DropStats::Drop (uint32_t device, ns3::Ptr<const ns3::Packet> p){
+        double now = ns3::Simulator::Now ().GetSeconds ();
+        uint32_t flow = Classify (p);
+
+        m_total++;
+        m_deviceDrops[device]++;
+        if (flow == NO_FLOW){
+                m_otherDrops++;
+        }
+        else{
+                m_flowDrops[flow]++;
+        }
+        m_buckets[std::min (static_cast<size_t> (now / m_bucketWidth), m_buckets.size () - 1)]++;
+
+        if (m_file){
+                DropRecord &r = m_buffer[m_used];
+                r.time = now;
+                r.device = device;
+                r.flow = flow;
+                r.size = p->GetSize ();
+                r.pad = 0;
+                if (++m_used == m_buffer.size ()){
+                        Flush ();
+                }
+        }
+}
+
+inline uint32_t DropStats::Classify (ns3::Ptr<const ns3::Packet> p) const{
+        if (m_ports.empty ()){
+                return NO_FLOW;
+        }
+        ns3::Ptr<ns3::Packet> copy = p->Copy ();
+        ns3::PppHeader ppp;
+        ns3::Ipv4Header ip;
+        ns3::TcpHeader tcp;
+        if (copy->RemoveHeader (ppp) == 0 || ppp.GetProtocol () != 0x0021
+            || copy->RemoveHeader (ip) == 0 || ip.GetProtocol () != ns3::TcpL4Protocol::PROT_NUMBER
+            || copy->PeekHeader (tcp) == 0){
+                return NO_FLOW;
+        }
+        std::unordered_map<uint16_t, uint32_t>::const_iterator it = m_ports.find (tcp.GetDestinationPort ());
+        if (it == m_ports.end ()){
+                it = m_ports.find (tcp.GetSourcePort ());
+        }
+        return it == m_ports.end () ? NO_FLOW : it->second;
+}
+
+inline void DropStats::Flush (void){
+        if (m_file && m_used > 0){
+                std::fwrite (m_buffer.data (), sizeof (DropRecord), m_used, m_file);
+        }
+        m_used = 0;
+}
+
+inline void DropStats::Report (void){
+        Flush ();
+        PrintSummary (std::cout);
+}
+
+inline void DropStats::PrintSummary (std::ostream &os) const{
+        os << "Drops: " << m_total << std::endl;
+        for (size_t i = 0; i < m_deviceLabels.size (); i++){
+                if (m_deviceDrops[i] > 0){
+                        os << "  device " << m_deviceLabels[i] << ": " << m_deviceDrops[i] << std::endl;
+                }
+        }
+        for (size_t i = 0; i < m_flowLabels.size (); i++){
+                os << "  flow " << m_flowLabels[i] << ": " << m_flowDrops[i] << std::endl;
+        }
+        if (m_otherDrops > 0){
+                os << "  other: " << m_otherDrops << std::endl;
+        }
+        for (size_t i = 0; i < m_buckets.size (); i++){
+                if (m_buckets[i] > 0){
+                        os << "  [" << i * m_bucketWidth << ", " << (i + 1) * m_bucketWidth << "): " << m_buckets[i] << std::endl;
+                }
+        }
+}
+
+#endif // DROP_STATS_H
@@ -0,0 +1,243 @@
+#ifndef FLOW_REPORT_H
+#define FLOW_REPORT_H
+
+/*
+  Per-flow throughput, latency and fairness report built on FlowMonitor.
+
+  Every interval the FlowMonitor counters are sampled to build a
+  throughput time series per flow and Jain's fairness index over the
+  flows active in that interval. At the end the series is written as CSV
+  and the per-flow summary, delay/jitter histograms, fairness and the
+  utilisation of each shared link as JSON.
+
+  Flows need not overlap, so fairness is the mean of the per-interval
+  index over the intervals with at least two active flows, and a link's
+  utilisation is its bytes received over the span from its first flow's
+  start to its last flow's stop.
+
+  Flows are matched to FlowMonitor flows by destination port, so only
+  the data direction of each TCP connection is reported.
+*/
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "ns3/core-module.h"
+#include "ns3/flow-monitor-module.h"
+#include "ns3/ipv4-flow-classifier.h"
+#include "sim-profiler.h"
+
+class FlowReport{
+
+        public:
+                FlowReport (ns3::Ptr<ns3::FlowMonitor> monitor, ns3::Ptr<ns3::Ipv4FlowClassifier> classifier, double interval);
+
+                //Flows with the same link label share that link of linkRate bits/s
+                void AddFlow (std::string label, uint16_t port, double start, double stop, std::string link, uint64_t linkRate);
+                void Start (void);
+                void Write (std::string prefix);
+
+        private:
+                struct Flow{
+                        std::string label;
+                        double start;
+                        double stop;
+                        std::string link;
+                        uint64_t lastRxBytes;
+                        std::vector<double> throughput;         // Mbps per interval
+                };
+
+                void Sample (void);
+                //Index of the flow the FlowMonitor flow belongs to, or -1
+                int Find (ns3::FlowId id);
+                static double Jain (const std::vector<double> &x);
+                //Flow active during the interval ending at sample t
+                bool Active (const Flow &f, size_t t) const;
+                //Mean Jain index over the intervals in which two or more of the flows were active, and how many there were
+                std::pair<double, size_t> MeanFairness (const std::vector<size_t> &flows) const;
+                static void WriteHistogram (std::ostream &os, const ns3::Histogram &h);
+
+                ns3::Ptr<ns3::FlowMonitor>              m_monitor;
+                ns3::Ptr<ns3::Ipv4FlowClassifier>      m_classifier;
+                double                                  m_interval;
+                std::vector<Flow>                       m_flows;
+                std::unordered_map<uint16_t, int>       m_ports;
+                std::unordered_map<ns3::FlowId, int>    m_ids;
+                std::map<std::string, uint64_t>         m_links;
+                std::vector<double>                     m_times;
+                std::vector<double>                     m_fairness;
+};
+
+inline FlowReport::FlowReport (ns3::Ptr<ns3::FlowMonitor> monitor, ns3::Ptr<ns3::Ipv4FlowClassifier> classifier, double interval)
+        : m_monitor (monitor),
+        m_classifier (classifier),
+        m_interval (interval)
+{
+}
+
+inline void FlowReport::AddFlow (std::string label, uint16_t port, double start, double stop, std::string link, uint64_t linkRate){
+        m_ports[port] = m_flows.size ();
+        m_flows.push_back (Flow {label, start, stop, link, 0, std::vector<double> ()});
+        m_links[link] = linkRate;
+}
+
+inline void FlowReport::Start (void){
+        ns3::Simulator::Schedule (ns3::Seconds (m_interval), &FlowReport::Sample, this);
+}
+
+inline int FlowReport::Find (ns3::FlowId id){
+        std::unordered_map<ns3::FlowId, int>::iterator it = m_ids.find (id);
+        if (it != m_ids.end ()){
+                return it->second;
+        }
+        ns3::Ipv4FlowClassifier::FiveTuple t = m_classifier->FindFlow (id);
+        std::unordered_map<uint16_t, int>::iterator p = m_ports.find (t.destinationPort);
+        int flow = p == m_ports.end () ? -1 : p->second;
+        m_ids[id] = flow;
+        return flow;
+}
+
+inline void FlowReport::Sample (void){
+        static const uint32_t profileId = SimProfiler::Register ("FlowReport");
+        SimProfiler::Scope scope (profileId);
+        double now = ns3::Simulator::Now ().GetSeconds ();
+        std::vector<uint64_t> rxBytes (m_flows.size (), 0);
+        for (const std::pair<const ns3::FlowId, ns3::FlowMonitor::FlowStats> &s : m_monitor->GetFlowStats ()){
+                int flow = Find (s.first);
+                if (flow >= 0){
+                        rxBytes[flow] += s.second.rxBytes;
+                }
+        }
+
+        m_times.push_back (now);
+        std::vector<double> active;
+        for (size_t i = 0; i < m_flows.size (); i++){
+                Flow &f = m_flows[i];
+                double mbps = (rxBytes[i] - f.lastRxBytes) * 8 / m_interval / 1e6;
+                f.throughput.push_back (mbps);
+                f.lastRxBytes = rxBytes[i];
+                if (Active (f, m_times.size () - 1)){
+                        active.push_back (mbps);
+                }
+        }
+        m_fairness.push_back (Jain (active));
+
+        ns3::Simulator::Schedule (ns3::Seconds (m_interval), &FlowReport::Sample, this);
+}
+
+inline double FlowReport::Jain (const std::vector<double> &x){
+        double sum = 0;
+        double squares = 0;
+        for (double v : x){
+                sum += v;
+                squares += v * v;
+        }
+        return squares > 0 ? sum * sum / (x.size () * squares) : 1.0;
+}
+
+inline bool FlowReport::Active (const Flow &f, size_t t) const{
+        return f.start < m_times[t] && m_times[t] - m_interval < f.stop;
+}
+
+inline std::pair<double, size_t> FlowReport::MeanFairness (const std::vector<size_t> &flows) const{
+        double sum = 0;
+        size_t intervals = 0;
+        for (size_t t = 0; t < m_times.size (); t++){
+                std::vector<double> active;
+                for (size_t i : flows){
+                        if (Active (m_flows[i], t)){
+                                active.push_back (m_flows[i].throughput[t]);
+                        }
+                }
+                if (active.size () >= 2){
+                        sum += Jain (active);
+                        intervals++;
+                }
+        }
+        return std::make_pair (intervals > 0 ? sum / intervals : 1.0, intervals);
+}
+
+inline void FlowReport::WriteHistogram (std::ostream &os, const ns3::Histogram &h){
+        os << "[";
+        bool first = true;
+        for (uint32_t i = 0; i < h.GetNBins (); i++){
+                if (h.GetBinCount (i) == 0){
+                        continue;
+                }
+                os << (first ? "" : ", ") << "[" << h.GetBinStart (i) << ", " << h.GetBinWidth (i) << ", " << h.GetBinCount (i) << "]";
+                first = false;
+        }
+        os << "]";
+}
+
+inline void FlowReport::Write (std::string prefix){
+        m_monitor->CheckForLostPackets ();
+
+        std::ofstream csv (prefix + "_flowmon_throughput.csv");
+        csv << "time,flow,throughputMbps\n";
+        for (size_t t = 0; t < m_times.size (); t++){
+                for (const Flow &f : m_flows){
+                        csv << m_times[t] << "," << f.label << "," << f.throughput[t] << "\n";
+                }
+                csv << m_times[t] << ",jain," << m_fairness[t] << "\n";
+        }
+
+        //Totals over the FlowMonitor flows of each of our flows
+        std::vector<ns3::FlowMonitor::FlowStats> totals (m_flows.size ());
+        std::vector<bool> seen (m_flows.size (), false);
+        for (const std::pair<const ns3::FlowId, ns3::FlowMonitor::FlowStats> &s : m_monitor->GetFlowStats ()){
+                int flow = Find (s.first);
+                if (flow >= 0 && !seen[flow]){
+                        totals[flow] = s.second;
+                        seen[flow] = true;
+                }
+        }
+
+        std::ofstream json (prefix + "_flowmon.json");
+        json << "{\n  \"flows\": [\n";
+        std::vector<size_t> all;
+        std::map<std::string, std::vector<size_t> > perLink;
+        for (size_t i = 0; i < m_flows.size (); i++){
+                const Flow &f = m_flows[i];
+                const ns3::FlowMonitor::FlowStats &s = totals[i];
+                double mbps = s.rxBytes * 8 / (f.stop - f.start) / 1e6;
+                all.push_back (i);
+                perLink[f.link].push_back (i);
+                json << "    {\"label\": \"" << f.label << "\", \"link\": \"" << f.link << "\""
+                     << ", \"txPackets\": " << s.txPackets << ", \"rxPackets\": " << s.rxPackets
+                     << ", \"lostPackets\": " << s.lostPackets << ", \"throughputMbps\": " << mbps
+                     << ", \"meanDelayMs\": " << (s.rxPackets > 0 ? s.delaySum.GetSeconds () * 1e3 / s.rxPackets : 0)
+                     << ", \"meanJitterMs\": " << (s.rxPackets > 1 ? s.jitterSum.GetSeconds () * 1e3 / (s.rxPackets - 1) : 0)
+                     << ",\n     \"delayHistogram\": ";
+                WriteHistogram (json, s.delayHistogram);
+                json << ",\n     \"jitterHistogram\": ";
+                WriteHistogram (json, s.jitterHistogram);
+                json << "}" << (i + 1 < m_flows.size () ? "," : "") << "\n";
+        }
+        std::pair<double, size_t> fairness = MeanFairness (all);
+        json << "  ],\n  \"jainFairness\": " << fairness.first << ", \"fairnessIntervals\": " << fairness.second
+             << ",\n  \"links\": [\n";
+        size_t n = 0;
+        for (const std::pair<const std::string, std::vector<size_t> > &l : perLink){
+                uint64_t bytes = 0;
+                double start = m_flows[l.second[0]].start;
+                double stop = m_flows[l.second[0]].stop;
+                for (size_t i : l.second){
+                        bytes += totals[i].rxBytes;
+                        start = std::min (start, m_flows[i].start);
+                        stop = std::max (stop, m_flows[i].stop);
+                }
+                fairness = MeanFairness (l.second);
+                json << "    {\"link\": \"" << l.first << "\", \"flows\": " << l.second.size ()
+                     << ", \"jainFairness\": " << fairness.first << ", \"fairnessIntervals\": " << fairness.second
+                     << ", \"utilisation\": " << (stop > start ? bytes * 8 / (stop - start) / m_links[l.first] : 0) << "}"
+                     << (++n < perLink.size () ? "," : "") << "\n";
+        }
+        json << "  ]\n}\n";
+}
+
+#endif // FLOW_REPORT_H
@@ -1,9 +1,37 @@
-./waf --run "scratch/First --tcp=TcpNewReno" 
-./waf --run "scratch/First --tcp=TcpNewRenoPlus" 
+# Run from the ns-3 root after copying the files of Part A and of Common
+# (sim-profiler.h, Sweep.cc, shared with the other part) into scratch/
 
+./waf --run "scratch/First --tcp=TcpNewReno --cwndTrace=binary" 
+./waf --run "scratch/First --tcp=TcpNewRenoPlus --cwndTrace=binary" 
+./waf --run "scratch/CwndStore build TcpNewReno_cwnd.bin TcpNewReno_cwnd.cwndc" 
+./waf --run "scratch/CwndStore build TcpNewRenoPlus_cwnd.bin TcpNewRenoPlus_cwnd.cwndc" 
+./waf --run "scratch/First --tcp=TcpNewRenoPlus --pacing=true" 
+./waf --run "scratch/First --tcp=TcpNewRenoPlus --aqm=FqCoDel --ecn=true --flowMonitor=true" 
+./waf --run "scratch/First --tcp=TcpNewRenoPlus --topology=dumbbell --queueSize=1000p --flowMonitor=true --delayCa=true" 
+./waf --run "scratch/First --tcp=TcpNewRenoPlus --recovery=TcpRandomLossPrrRecovery --errorRate=0.0001" 
+./waf --run "scratch/First --tcp=TcpNewReno --replications=10" 
+./waf --run "scratch/First --tcp=TcpNewRenoPlus --replications=10" 
+./waf --run "scratch/First --tcp=TcpNewRenoPlus --topology=dumbbell --senders=100 --flows=1000 --bottleneckRate=1Gbps --traceFlows=0" 
+./waf --run "scratch/First --tcp=TcpNewRenoPlus --topology=dumbbell --senders=100 --flows=1000 --bottleneckRate=1Gbps --traceFlows=1000 --cwndTrace=binary" 
+
+# gnuplot runs build/scratch/CwndStore outside waf, which would otherwise not find the ns-3 libraries
+export LD_LIBRARY_PATH="$PWD/build/lib${LD_LIBRARY_PATH:+:$LD_LIBRARY_PATH}"
 gnuplot congestion1.plt
 gnuplot congestion2.plt
 gnuplot congestion3.plt
 gnuplot congestion4.plt
 gnuplot congestion5.plt
-gnuplot congestion6.plt
\ No newline at end of file
+gnuplot congestion6.plt
+
+./waf --run "scratch/CongestionOpsBench"
+./waf --run "scratch/CongestionOpsBench --segmentsAcked=2"
+
+./waf --run "scratch/Sweep --program=build/scratch/First --out=sweepA --grid=tcp=TcpNewReno,TcpNewRenoPlus --grid=errorRate=0,0.00001 --grid=flows=3,30 --grid=RngRun=1,2,3,4 --arg=--traceFlows=0"
+
+./waf --run "scratch/First --tcp=TcpNewReno --topology=lfn --bottleneckRate=10Gbps --rtt=100ms --simTime=10 --traceFlows=0"
+./waf --run "scratch/First --tcp=TcpNewRenoPlus --topology=lfn --bottleneckRate=10Gbps --rtt=100ms --simTime=10 --traceFlows=0"
+./waf --run "scratch/Sweep --program=build/scratch/First --out=sweepLfn --grid=tcp=TcpNewReno,TcpNewRenoPlus --grid=bottleneckRate=1Gbps,10Gbps --grid=errorRate=0,0.000001 --arg=--topology=lfn --arg=--simTime=10 --arg=--traceFlows=0 --metric=t90=utilisation: --metric=events=Events/s:"
+
+./waf --run "scratch/First --tcp=TcpNewRenoPlus --cwndTrace=bins --binWidth=0.01"
+gnuplot -e "bins=1" congestion4.plt
+./waf --run "scratch/First --tcp=TcpNewRenoPlus --topology=dumbbell --senders=100 --flows=1000 --bottleneckRate=1Gbps --traceFlows=1000 --cwndTrace=bins"
@@ -2,6 +2,13 @@
 #include "tcp-congestion-ops.h"
 #include "tcp-socket-base.h"
 #include "ns3/log.h"
+#include "ns3/double.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <cmath>
 
 namespace ns3 {
 
@@ -13,41 +20,384 @@ namespace ns3 {
         static TypeId tid = TypeId ("ns3::TcpNewRenoPlus")
             .SetParent<TcpNewReno> ()
             .SetGroupName ("Internet")
-            .AddConstructor<TcpNewRenoPlus> ();
+            .AddConstructor<TcpNewRenoPlus> ()
+            .AddAttribute ("SlowStartExponent",
+                           "Exponent applied to the segment size in the slow start increment",
+                           DoubleValue (1.91),
+                           MakeDoubleAccessor (&TcpNewRenoPlus::SetSlowStartExponent,
+                                               &TcpNewRenoPlus::GetSlowStartExponent),
+                           MakeDoubleChecker<double> (0.0))
+            .AddAttribute ("SlowStartMultiplier",
+                           "Multiplier of the slow start increment",
+                           DoubleValue (1.0),
+                           MakeDoubleAccessor (&TcpNewRenoPlus::SetSlowStartMultiplier,
+                                               &TcpNewRenoPlus::GetSlowStartMultiplier),
+                           MakeDoubleChecker<double> (0.0))
+            .AddAttribute ("CongAvoidFactor",
+                           "Fraction of a segment added to cwnd per ACK in congestion avoidance",
+                           DoubleValue (0.51),
+                           MakeDoubleAccessor (&TcpNewRenoPlus::SetCongAvoidFactor,
+                                               &TcpNewRenoPlus::GetCongAvoidFactor),
+                           MakeDoubleChecker<double> (0.0))
+            .AddAttribute ("StretchAckGrowth",
+                           "Scale the congestion avoidance increment by the segments covered by each ACK",
+                           BooleanValue (false),
+                           MakeBooleanAccessor (&TcpNewRenoPlus::m_stretchAckGrowth),
+                           MakeBooleanChecker ())
+            .AddAttribute ("Pacing",
+                           "Enable pacing on the socket, at the cwnd/RTT rate scaled by TcpSocketState's PacingSsRatio and PacingCaRatio",
+                           BooleanValue (false),
+                           MakeBooleanAccessor (&TcpNewRenoPlus::m_pacing),
+                           MakeBooleanChecker ())
+            .AddAttribute ("HyStart",
+                           "Leave slow start on an ACK train or RTT increase before loss",
+                           BooleanValue (false),
+                           MakeBooleanAccessor (&TcpNewRenoPlus::m_hystart),
+                           MakeBooleanChecker ())
+            .AddAttribute ("HyStartLowWindow",
+                           "Lower bound cWnd (in segments) for HyStart",
+                           UintegerValue (16),
+                           MakeUintegerAccessor (&TcpNewRenoPlus::m_hystartLowWindow),
+                           MakeUintegerChecker<uint32_t> ())
+            .AddAttribute ("HyStartMinSamples",
+                           "RTT samples per round needed before checking for an RTT increase",
+                           UintegerValue (8),
+                           MakeUintegerAccessor (&TcpNewRenoPlus::m_hystartMinSamples),
+                           MakeUintegerChecker<uint32_t> (1))
+            .AddAttribute ("HyStartAckDelta",
+                           "Spacing between ACKs indicating an ACK train",
+                           TimeValue (MilliSeconds (2)),
+                           MakeTimeAccessor (&TcpNewRenoPlus::m_hystartAckDelta),
+                           MakeTimeChecker ())
+            .AddAttribute ("HyStartDelayMin",
+                           "Minimum RTT increase for leaving slow start",
+                           TimeValue (MilliSeconds (4)),
+                           MakeTimeAccessor (&TcpNewRenoPlus::m_hystartDelayMin),
+                           MakeTimeChecker ())
+            .AddAttribute ("HyStartDelayMax",
+                           "Maximum RTT increase for leaving slow start",
+                           TimeValue (MilliSeconds (16)),
+                           MakeTimeAccessor (&TcpNewRenoPlus::m_hystartDelayMax),
+                           MakeTimeChecker ())
+            .AddAttribute ("EcnBeta",
+                           "Multiplicative decrease of the window on an ECN echo, instead of halving",
+                           DoubleValue (0.8),
+                           MakeDoubleAccessor (&TcpNewRenoPlus::m_ecnBeta),
+                           MakeDoubleChecker<double> (0.0, 1.0))
+            .AddAttribute ("DelayBasedCa",
+                           "Keep cwnd near the bandwidth-delay product from base and current RTT (Vegas-style)",
+                           BooleanValue (false),
+                           MakeBooleanAccessor (&TcpNewRenoPlus::m_delayBasedCa),
+                           MakeBooleanChecker ())
+            .AddAttribute ("DelayAlpha",
+                           "Segments queued in the network below which delay-based CA grows cwnd",
+                           UintegerValue (2),
+                           MakeUintegerAccessor (&TcpNewRenoPlus::m_delayAlpha),
+                           MakeUintegerChecker<uint32_t> ())
+            .AddAttribute ("DelayBeta",
+                           "Segments queued in the network above which delay-based CA shrinks cwnd",
+                           UintegerValue (4),
+                           MakeUintegerAccessor (&TcpNewRenoPlus::m_delayBeta),
+                           MakeUintegerChecker<uint32_t> ())
+            .AddAttribute ("DelayGamma",
+                           "Segments queued in the network above which delay-based CA ends slow start",
+                           UintegerValue (1),
+                           MakeUintegerAccessor (&TcpNewRenoPlus::m_delayGamma),
+                           MakeUintegerChecker<uint32_t> ());
         return tid;
     }
 
-    TcpNewRenoPlus::TcpNewRenoPlus (void) : TcpNewReno (){
+    TcpNewRenoPlus::TcpNewRenoPlus (void) : TcpNewReno (),
+        m_ssExponent (1.91),
+        m_ssMultiplier (1.0),
+        m_caFactor (0.51),
+        m_stretchAckGrowth (false),
+        m_growthSegmentSize (0),
+        m_ssGrowth (0),
+        m_caIncrement (0),
+        m_caRemainder (0),
+        m_pacing (false),
+        m_minRtt (Time::Max ()),
+        m_hystart (false),
+        m_hystartLowWindow (16),
+        m_hystartMinSamples (8),
+        m_hystartAckDelta (MilliSeconds (2)),
+        m_hystartDelayMin (MilliSeconds (4)),
+        m_hystartDelayMax (MilliSeconds (16)),
+        m_hystartFound (false),
+        m_hystartEndSeq (0),
+        m_hystartRoundStart (Time (0)),
+        m_hystartLastAck (Time (0)),
+        m_currRoundMinRtt (Time::Max ()),
+        m_lastRoundMinRtt (Time::Max ()),
+        m_hystartSampleCnt (0),
+        m_ecnBeta (0.8),
+        m_delayBasedCa (false),
+        m_delayAlpha (2),
+        m_delayBeta (4),
+        m_delayGamma (1),
+        m_delayAction (DELAY_GROW),
+        m_delayShrunk (false),
+        m_delayEndSeq (0),
+        m_delayRoundMinRtt (Time::Max ()){
     NS_LOG_FUNCTION (this);
     }
 
-    TcpNewRenoPlus::TcpNewRenoPlus (const TcpNewRenoPlus& sock): TcpNewReno (sock){
+    TcpNewRenoPlus::TcpNewRenoPlus (const TcpNewRenoPlus& sock): TcpNewReno (sock),
+        m_ssExponent (sock.m_ssExponent),
+        m_ssMultiplier (sock.m_ssMultiplier),
+        m_caFactor (sock.m_caFactor),
+        m_stretchAckGrowth (sock.m_stretchAckGrowth),
+        m_growthSegmentSize (sock.m_growthSegmentSize),
+        m_ssGrowth (sock.m_ssGrowth),
+        m_caIncrement (sock.m_caIncrement),
+        m_caRemainder (0),
+        m_pacing (sock.m_pacing),
+        m_minRtt (Time::Max ()),
+        m_hystart (sock.m_hystart),
+        m_hystartLowWindow (sock.m_hystartLowWindow),
+        m_hystartMinSamples (sock.m_hystartMinSamples),
+        m_hystartAckDelta (sock.m_hystartAckDelta),
+        m_hystartDelayMin (sock.m_hystartDelayMin),
+        m_hystartDelayMax (sock.m_hystartDelayMax),
+        m_hystartFound (false),
+        m_hystartEndSeq (0),
+        m_hystartRoundStart (Time (0)),
+        m_hystartLastAck (Time (0)),
+        m_currRoundMinRtt (Time::Max ()),
+        m_lastRoundMinRtt (Time::Max ()),
+        m_hystartSampleCnt (0),
+        m_ecnBeta (sock.m_ecnBeta),
+        m_delayBasedCa (sock.m_delayBasedCa),
+        m_delayAlpha (sock.m_delayAlpha),
+        m_delayBeta (sock.m_delayBeta),
+        m_delayGamma (sock.m_delayGamma),
+        m_delayAction (DELAY_GROW),
+        m_delayShrunk (false),
+        m_delayEndSeq (0),
+        m_delayRoundMinRtt (Time::Max ()){
     NS_LOG_FUNCTION (this);
     }
 
     TcpNewRenoPlus::~TcpNewRenoPlus (void){
     }
 
+    void TcpNewRenoPlus::SetSlowStartExponent (double exponent){
+    NS_LOG_FUNCTION (this << exponent);
+    m_ssExponent = exponent;
+    m_growthSegmentSize = 0;
+    }
+
+    double TcpNewRenoPlus::GetSlowStartExponent (void) const{
+    return m_ssExponent;
+    }
+
+    void TcpNewRenoPlus::SetSlowStartMultiplier (double multiplier){
+    NS_LOG_FUNCTION (this << multiplier);
+    m_ssMultiplier = multiplier;
+    m_growthSegmentSize = 0;
+    }
+
+    double TcpNewRenoPlus::GetSlowStartMultiplier (void) const{
+    return m_ssMultiplier;
+    }
+
+    void TcpNewRenoPlus::SetCongAvoidFactor (double factor){
+    NS_LOG_FUNCTION (this << factor);
+    m_caFactor = factor;
+    m_growthSegmentSize = 0;
+    }
+
+    double TcpNewRenoPlus::GetCongAvoidFactor (void) const{
+    return m_caFactor;
+    }
+
+    void TcpNewRenoPlus::UpdateGrowth (uint32_t segmentSize){
+    NS_LOG_FUNCTION (this << segmentSize);
+
+    m_ssGrowth = static_cast<uint64_t> (m_ssMultiplier * std::pow (segmentSize, m_ssExponent));
+    m_caIncrement = static_cast<uint64_t> (m_caFactor * segmentSize * (1 << CA_FRACTION_BITS));
+    m_growthSegmentSize = segmentSize;
+    NS_LOG_DEBUG ("Growth terms for MSS " << segmentSize << ": slow start " << m_ssGrowth
+                  << " congestion avoidance " << m_caIncrement << "/" << (1 << CA_FRACTION_BITS));
+    }
+
+    void TcpNewRenoPlus::Init (Ptr<TcpSocketState> tcb){
+    NS_LOG_FUNCTION (this << tcb);
+
+    // The socket derives the rate from cwnd/srtt on every ACK, scaled by
+    // TcpSocketState's PacingSsRatio and PacingCaRatio
+    if (m_pacing){
+        tcb->m_pacing = true;
+        }
+    }
+
+    void TcpNewRenoPlus::PktsAcked (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked, const Time& rtt){
+    NS_LOG_FUNCTION (this << tcb << segmentsAcked << rtt);
+
+    if (rtt.IsZero ()){
+        return;
+        }
+
+    m_minRtt = std::min (m_minRtt, rtt);
+
+    if (m_hystart){
+        if (tcb->m_lastAckedSeq >= m_hystartEndSeq){
+            HyStartReset (tcb);
+            }
+        if (!m_hystartFound && tcb->m_cWnd < tcb->m_ssThresh
+            && tcb->m_cWnd >= m_hystartLowWindow * tcb->m_segmentSize){
+            HyStartUpdate (tcb, rtt);
+            }
+        }
+
+    if (m_delayBasedCa){
+        DelayUpdate (tcb, rtt);
+        }
+    }
+
+    void TcpNewRenoPlus::DelayUpdate (Ptr<TcpSocketState> tcb, const Time& rtt){
+    NS_LOG_FUNCTION (this << tcb << rtt);
+
+    if (tcb->m_lastAckedSeq >= m_delayEndSeq){
+        if (m_delayRoundMinRtt != Time::Max ()){
+            // Segments sitting in queues: cwnd * (rtt - baseRtt) / rtt
+            double segments = static_cast<double> (tcb->m_cWnd) / tcb->m_segmentSize;
+            double queued = segments * (m_delayRoundMinRtt - m_minRtt).GetSeconds () / m_delayRoundMinRtt.GetSeconds ();
+
+            if (tcb->m_cWnd < tcb->m_ssThresh && queued > m_delayGamma){
+                tcb->m_ssThresh = std::max (tcb->m_cWnd.Get (), 2 * tcb->m_segmentSize);
+                NS_LOG_INFO ("Delay-based CA ends slow start with " << queued << " segments queued");
+                }
+
+            m_delayAction = (queued < m_delayAlpha) ? DELAY_GROW : (queued > m_delayBeta) ? DELAY_SHRINK : DELAY_HOLD;
+            NS_LOG_DEBUG ("Round min RTT " << m_delayRoundMinRtt << " base " << m_minRtt
+                          << " queued " << queued << " action " << m_delayAction);
+            }
+        m_delayEndSeq = tcb->m_highTxMark;
+        m_delayRoundMinRtt = Time::Max ();
+        m_delayShrunk = false;
+        }
+    m_delayRoundMinRtt = std::min (m_delayRoundMinRtt, rtt);
+    }
+
+    void TcpNewRenoPlus::CongestionStateSet (Ptr<TcpSocketState> tcb, const TcpSocketState::TcpCongState_t newState){
+    NS_LOG_FUNCTION (this << tcb << newState);
+
+    // After a timeout the window restarts from slow start, which HyStart may end again
+    if (newState == TcpSocketState::CA_LOSS){
+        m_hystartFound = false;
+        m_lastRoundMinRtt = Time::Max ();
+        }
+    }
+
+    uint32_t TcpNewRenoPlus::GetSsThresh (Ptr<const TcpSocketState> tcb, uint32_t bytesInFlight){
+    NS_LOG_FUNCTION (this << tcb << bytesInFlight);
+
+    // An ECN echo marks a queue building up, not a dropped packet, so back off
+    // less than for loss (as in RFC 8511).
+    double beta = (tcb->m_ecnState == TcpSocketState::ECN_ECE_RCVD) ? m_ecnBeta : 0.5;
+    return std::max (2 * tcb->m_segmentSize, static_cast<uint32_t> (bytesInFlight * beta));
+    }
+
+    void TcpNewRenoPlus::HyStartReset (Ptr<TcpSocketState> tcb){
+    NS_LOG_FUNCTION (this << tcb);
+
+    m_hystartRoundStart = m_hystartLastAck = Simulator::Now ();
+    m_hystartEndSeq = tcb->m_highTxMark;
+    m_lastRoundMinRtt = m_currRoundMinRtt;
+    m_currRoundMinRtt = Time::Max ();
+    m_hystartSampleCnt = 0;
+    }
+
+    void TcpNewRenoPlus::HyStartUpdate (Ptr<TcpSocketState> tcb, const Time& rtt){
+    NS_LOG_FUNCTION (this << tcb << rtt);
+
+    Time now = Simulator::Now ();
+
+    // ACK train: closely spaced ACKs spanning half the base RTT fill the pipe
+    if (now - m_hystartLastAck <= m_hystartAckDelta){
+        m_hystartLastAck = now;
+        if (now - m_hystartRoundStart > NanoSeconds (m_minRtt.GetNanoSeconds () / 2)){
+            m_hystartFound = true;
+            NS_LOG_DEBUG ("HyStart ACK train detected at cwnd " << tcb->m_cWnd);
+            }
+        }
+
+    // Delay increase: the round's minimum RTT grew past the previous round's
+    if (m_hystartSampleCnt < m_hystartMinSamples){
+        m_currRoundMinRtt = std::min (m_currRoundMinRtt, rtt);
+        ++m_hystartSampleCnt;
+        }
+    else if (m_lastRoundMinRtt != Time::Max ()){
+        Time eta = std::min (std::max (NanoSeconds (m_lastRoundMinRtt.GetNanoSeconds () / 8), m_hystartDelayMin),
+                             m_hystartDelayMax);
+        if (m_currRoundMinRtt > m_lastRoundMinRtt + eta){
+            m_hystartFound = true;
+            NS_LOG_DEBUG ("HyStart delay increase " << m_currRoundMinRtt << " over " << m_lastRoundMinRtt);
+            }
+        }
+
+    if (m_hystartFound){
+        tcb->m_ssThresh = tcb->m_cWnd;
+        NS_LOG_INFO ("HyStart exits slow start, ssthresh " << tcb->m_ssThresh);
+        }
+    }
+
     uint32_t TcpNewRenoPlus::SlowStart (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked){
     NS_LOG_FUNCTION (this << tcb << segmentsAcked);
 
-    if (segmentsAcked >= 1){
-        double adder = static_cast<double> (pow(tcb->m_segmentSize, 1.91)) / tcb->m_cWnd.Get ();
-        tcb->m_cWnd += static_cast<uint32_t> (adder);
+    if (tcb->m_segmentSize != m_growthSegmentSize){
+        UpdateGrowth (tcb->m_segmentSize);
+        }
+
+    // Each acked segment adds MSS^exponent / cwnd, as a single integer update
+    // of the window; segments left over once ssthresh is reached go to CA.
+    uint32_t cWnd = tcb->m_cWnd;
+    uint32_t ssThresh = tcb->m_ssThresh;
+    while (segmentsAcked > 0 && cWnd < ssThresh){
+        cWnd += static_cast<uint32_t> (m_ssGrowth / std::max<uint32_t> (cWnd, 1));
+        --segmentsAcked;
+        }
+
+    if (cWnd != tcb->m_cWnd){
+        tcb->m_cWnd = cWnd;
         NS_LOG_INFO ("In SlowStart, updated to cwnd " << tcb->m_cWnd << " ssthresh " << tcb->m_ssThresh);
-        return segmentsAcked - 1;
         }
 
-    return 0;
+    return segmentsAcked;
     }
 
     void TcpNewRenoPlus::CongestionAvoidance (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked){
     NS_LOG_FUNCTION (this << tcb << segmentsAcked);
 
-    if (segmentsAcked > 0){
-        // tcb->m_cWnd += tcb->m_segmentSize;
-        double adder = static_cast<double> (tcb->m_segmentSize * 0.51);
-        tcb->m_cWnd += static_cast<uint32_t> (adder);
+    if (segmentsAcked > 0 && m_delayBasedCa){
+        // One segment per round up or down, or nothing, as decided from the RTT
+        if (m_delayAction == DELAY_GROW){
+            TcpNewReno::CongestionAvoidance (tcb, segmentsAcked);
+            }
+        else if (m_delayAction == DELAY_SHRINK && !m_delayShrunk){
+            tcb->m_cWnd = std::max (tcb->m_cWnd.Get () - tcb->m_segmentSize, 2 * tcb->m_segmentSize);
+            tcb->m_ssThresh = std::min (tcb->m_ssThresh.Get (), tcb->m_cWnd.Get ());
+            m_delayShrunk = true;
+            }
+        NS_LOG_INFO ("In delay-based CongAvoid, cwnd " << tcb->m_cWnd << " ssthresh " << tcb->m_ssThresh);
+        }
+    else if (segmentsAcked > 0){
+        if (tcb->m_segmentSize != m_growthSegmentSize){
+            UpdateGrowth (tcb->m_segmentSize);
+            }
+
+        if (m_stretchAckGrowth){
+            // Growth for every segment the (stretch) ACK covers, keeping the
+            // sub-byte part for the next ACK instead of truncating it away.
+            uint64_t growth = m_caIncrement * segmentsAcked + m_caRemainder;
+            m_caRemainder = static_cast<uint32_t> (growth & ((1 << CA_FRACTION_BITS) - 1));
+            tcb->m_cWnd += static_cast<uint32_t> (growth >> CA_FRACTION_BITS);
+            }
+        else{
+            tcb->m_cWnd += static_cast<uint32_t> (m_caIncrement >> CA_FRACTION_BITS);
+            }
         NS_LOG_INFO ("In CongAvoid, updated to cwnd " << tcb->m_cWnd << " ssthresh " << tcb->m_ssThresh);
         }
     }
@@ -56,5 +406,90 @@ namespace ns3 {
         return "TcpNewRenoPlus";
     }
 
-} // namespace ns3
+    Ptr<TcpCongestionOps> TcpNewRenoPlus::Fork (){
+        return CopyObject<TcpNewRenoPlus> (this);
+    }
+
+    NS_OBJECT_ENSURE_REGISTERED (TcpRandomLossPrrRecovery);
 
+    TypeId TcpRandomLossPrrRecovery::GetTypeId (void){
+        static TypeId tid = TypeId ("ns3::TcpRandomLossPrrRecovery")
+            .SetParent<TcpPrrRecovery> ()
+            .SetGroupName ("Internet")
+            .AddConstructor<TcpRandomLossPrrRecovery> ()
+            .AddAttribute ("RandomLossBeta",
+                           "Multiplicative decrease of the window for a loss seen without queueing delay",
+                           DoubleValue (0.85),
+                           MakeDoubleAccessor (&TcpRandomLossPrrRecovery::m_randomLossBeta),
+                           MakeDoubleChecker<double> (0.0, 1.0))
+            .AddAttribute ("QueueDelayThreshold",
+                           "Queueing delay, as a fraction of the minimum RTT, below which a loss is taken as random",
+                           DoubleValue (0.25),
+                           MakeDoubleAccessor (&TcpRandomLossPrrRecovery::m_queueDelayThreshold),
+                           MakeDoubleChecker<double> (0.0));
+        return tid;
+    }
+
+    TcpRandomLossPrrRecovery::TcpRandomLossPrrRecovery (void)
+        : TcpPrrRecovery (),
+        m_randomLossBeta (0.85),
+        m_queueDelayThreshold (0.25),
+        m_randomLosses (0),
+        m_congestionLosses (0){
+    NS_LOG_FUNCTION (this);
+    }
+
+    TcpRandomLossPrrRecovery::TcpRandomLossPrrRecovery (const TcpRandomLossPrrRecovery& recovery)
+        : TcpPrrRecovery (recovery),
+        m_randomLossBeta (recovery.m_randomLossBeta),
+        m_queueDelayThreshold (recovery.m_queueDelayThreshold),
+        m_randomLosses (0),
+        m_congestionLosses (0){
+    NS_LOG_FUNCTION (this);
+    }
+
+    TcpRandomLossPrrRecovery::~TcpRandomLossPrrRecovery (void){
+    NS_LOG_FUNCTION (this);
+    }
+
+    void TcpRandomLossPrrRecovery::EnterRecovery (Ptr<TcpSocketState> tcb, uint32_t dupAckCount,
+                                                  uint32_t unAckDataCount, uint32_t deliveredBytes){
+    NS_LOG_FUNCTION (this << tcb << dupAckCount << unAckDataCount << deliveredBytes);
+
+    // The socket has already set ssThresh from the congestion control; cwnd
+    // still holds the window the loss happened at.
+    Time minRtt = tcb->m_minRtt;
+    Time queueing = tcb->m_lastRtt.Get () - minRtt;
+    if (minRtt != Time::Max () && !tcb->m_lastRtt.Get ().IsZero ()
+        && queueing.GetSeconds () <= minRtt.GetSeconds () * m_queueDelayThreshold){
+        tcb->m_ssThresh = std::max (tcb->m_ssThresh.Get (),
+                                    std::max (2 * tcb->m_segmentSize,
+                                              static_cast<uint32_t> (tcb->m_cWnd.Get () * m_randomLossBeta)));
+        m_randomLosses++;
+        NS_LOG_INFO ("Random loss, queueing delay " << queueing << ", ssthresh " << tcb->m_ssThresh);
+        }
+    else{
+        m_congestionLosses++;
+        NS_LOG_INFO ("Congestion loss, queueing delay " << queueing << ", ssthresh " << tcb->m_ssThresh);
+        }
+
+    // PRR then paces the reduction towards the chosen ssThresh
+    TcpPrrRecovery::EnterRecovery (tcb, dupAckCount, unAckDataCount, deliveredBytes);
+    }
+
+    void TcpRandomLossPrrRecovery::ExitRecovery (Ptr<TcpSocketState> tcb){
+    NS_LOG_FUNCTION (this << tcb);
+
+    TcpPrrRecovery::ExitRecovery (tcb);
+    NS_LOG_DEBUG ("Recoveries so far: " << m_randomLosses << " random, " << m_congestionLosses << " congestion");
+    }
+
+    std::string TcpRandomLossPrrRecovery::GetName () const{
+        return "TcpRandomLossPrrRecovery";
+    }
+
+    Ptr<TcpRecoveryOps> TcpRandomLossPrrRecovery::Fork (){
+        return CopyObject<TcpRandomLossPrrRecovery> (this);
+    }
+
+} // namespace ns3
@@ -3,6 +3,7 @@
 
 #include "ns3/tcp-congestion-ops.h"
 #include "ns3/tcp-recovery-ops.h"
+#include "ns3/tcp-prr-recovery.h"
 
 namespace ns3 {
 
@@ -24,9 +25,174 @@ public:
 
   std::string GetName () const;
 
+  virtual Ptr<TcpCongestionOps> Fork ();
+
+  virtual void Init (Ptr<TcpSocketState> tcb);
+
+  virtual void PktsAcked (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked,
+                          const Time& rtt);
+
+  virtual void CongestionStateSet (Ptr<TcpSocketState> tcb,
+                                   const TcpSocketState::TcpCongState_t newState);
+
+  virtual uint32_t GetSsThresh (Ptr<const TcpSocketState> tcb,
+                                uint32_t bytesInFlight);
+
+  /**
+   * \brief Set the exponent applied to the segment size in slow start.
+   * \param exponent the new exponent
+   */
+  void SetSlowStartExponent (double exponent);
+
+  /**
+   * \brief Get the exponent applied to the segment size in slow start.
+   * \returns the exponent
+   */
+  double GetSlowStartExponent (void) const;
+
+  /**
+   * \brief Set the multiplier of the slow start growth term.
+   * \param multiplier the new multiplier
+   */
+  void SetSlowStartMultiplier (double multiplier);
+
+  /**
+   * \brief Get the multiplier of the slow start growth term.
+   * \returns the multiplier
+   */
+  double GetSlowStartMultiplier (void) const;
+
+  /**
+   * \brief Set the fraction of a segment added to cwnd per ACK in congestion avoidance.
+   * \param factor the new factor
+   */
+  void SetCongAvoidFactor (double factor);
+
+  /**
+   * \brief Get the fraction of a segment added to cwnd per ACK in congestion avoidance.
+   * \returns the factor
+   */
+  double GetCongAvoidFactor (void) const;
+
 protected:
   virtual uint32_t SlowStart (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked);
   virtual void CongestionAvoidance (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked);
+
+private:
+  /**
+   * \brief Recompute the cached slow start and congestion avoidance growth terms.
+   * \param segmentSize the segment size of the socket
+   */
+  void UpdateGrowth (uint32_t segmentSize);
+
+  /**
+   * \brief Start a new HyStart round, ending when the current high mark is acked.
+   * \param tcb internal congestion state
+   */
+  void HyStartReset (Ptr<TcpSocketState> tcb);
+
+  /**
+   * \brief Look for an ACK train or an RTT increase and leave slow start if found.
+   * \param tcb internal congestion state
+   * \param rtt last RTT sample
+   */
+  void HyStartUpdate (Ptr<TcpSocketState> tcb, const Time& rtt);
+
+  /**
+   * \brief Track the per-round minimum RTT and, at the end of each round,
+   * decide whether delay-based congestion avoidance grows, holds or shrinks cwnd.
+   * \param tcb internal congestion state
+   * \param rtt last RTT sample
+   */
+  void DelayUpdate (Ptr<TcpSocketState> tcb, const Time& rtt);
+
+  /**
+   * \brief Window adjustment chosen by delay-based congestion avoidance
+   */
+  enum DelayAction
+  {
+    DELAY_GROW,   //!< Fewer than alpha segments queued
+    DELAY_HOLD,   //!< Between alpha and beta segments queued
+    DELAY_SHRINK  //!< More than beta segments queued
+  };
+
+  static const uint32_t CA_FRACTION_BITS = 10; //!< Fractional bits of the fixed-point CA increment
+
+  double m_ssExponent;             //!< Exponent applied to the segment size in slow start
+  double m_ssMultiplier;           //!< Multiplier of the slow start growth term
+  double m_caFactor;               //!< Fraction of a segment added per ACK in congestion avoidance
+  bool m_stretchAckGrowth;         //!< Scale the CA increment by the number of segments acked
+  uint32_t m_growthSegmentSize;    //!< Segment size the cached terms were computed for (0 if stale)
+  uint64_t m_ssGrowth;             //!< Cached m_ssMultiplier * segmentSize^m_ssExponent
+  uint64_t m_caIncrement;          //!< Cached m_caFactor * segmentSize, fixed point
+  uint32_t m_caRemainder;          //!< Fractional bytes of CA growth carried between ACKs
+  bool m_pacing;                   //!< Enable pacing on the socket
+  Time m_minRtt;                   //!< Minimum RTT seen over the connection
+  bool m_hystart;                  //!< Leave slow start early on HyStart detection
+  uint32_t m_hystartLowWindow;     //!< Segments of cwnd below which HyStart is not used
+  uint32_t m_hystartMinSamples;    //!< RTT samples per round before the delay check
+  Time m_hystartAckDelta;          //!< Spacing for ACKs to belong to the same train
+  Time m_hystartDelayMin;          //!< Minimum RTT increase that ends slow start
+  Time m_hystartDelayMax;          //!< Maximum RTT increase that ends slow start
+  bool m_hystartFound;             //!< HyStart already ended this slow start
+  SequenceNumber32 m_hystartEndSeq; //!< High mark ending the current round
+  Time m_hystartRoundStart;        //!< Start of the current round
+  Time m_hystartLastAck;           //!< Last ACK of the current ACK train
+  Time m_currRoundMinRtt;          //!< Minimum RTT of the current round
+  Time m_lastRoundMinRtt;          //!< Minimum RTT of the previous round
+  uint32_t m_hystartSampleCnt;     //!< RTT samples taken in the current round
+  double m_ecnBeta;                //!< Multiplicative decrease applied on an ECN echo
+  bool m_delayBasedCa;             //!< Hold cwnd near the BDP from RTT instead of growing until loss
+  uint32_t m_delayAlpha;           //!< Queued segments below which cwnd grows
+  uint32_t m_delayBeta;            //!< Queued segments above which cwnd shrinks
+  uint32_t m_delayGamma;           //!< Queued segments above which slow start ends
+  DelayAction m_delayAction;       //!< Decision taken at the end of the last round
+  bool m_delayShrunk;              //!< cwnd was already reduced in this round
+  SequenceNumber32 m_delayEndSeq;  //!< High mark ending the current round
+  Time m_delayRoundMinRtt;         //!< Minimum RTT of the current round
+};
+
+/**
+ * \brief Proportional rate reduction (TcpPrrRecovery) towards a target that
+ * depends on whether the loss looks random or caused by congestion.
+ *
+ * A loss found while the last RTT sample exceeds the minimum RTT by at most
+ * QueueDelayThreshold times the minimum RTT happened with no queue built
+ * up, so it is taken as random (link error) and the window is reduced by
+ * RandomLossBeta only. Otherwise the reduction chosen by the congestion
+ * control is kept. Losses are still detected by the socket (duplicate ACKs
+ * and the retransmission timer); only the reduction differs.
+ */
+class TcpRandomLossPrrRecovery : public TcpPrrRecovery
+{
+public:
+
+  static TypeId GetTypeId (void);
+
+  TcpRandomLossPrrRecovery ();
+
+  /**
+   * \brief Copy constructor.
+   * \param recovery object to copy.
+   */
+  TcpRandomLossPrrRecovery (const TcpRandomLossPrrRecovery& recovery);
+
+  virtual ~TcpRandomLossPrrRecovery ();
+
+  virtual std::string GetName () const;
+
+  virtual void EnterRecovery (Ptr<TcpSocketState> tcb, uint32_t dupAckCount,
+                              uint32_t unAckDataCount, uint32_t deliveredBytes);
+
+  virtual void ExitRecovery (Ptr<TcpSocketState> tcb);
+
+  virtual Ptr<TcpRecoveryOps> Fork ();
+
+private:
+  double m_randomLossBeta;         //!< Multiplicative decrease for a loss without queueing delay
+  double m_queueDelayThreshold;    //!< Queueing delay, as a fraction of the min RTT, below which a loss is random
+  uint32_t m_randomLosses;         //!< Recoveries classified as random loss
+  uint32_t m_congestionLosses;     //!< Recoveries classified as congestion loss
 };
 
 } // namespace ns3
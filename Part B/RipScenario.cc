@@ -0,0 +1,829 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 Universita' di Firenze, Italy
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Tommaso Pecorella <tommaso.pecorella@unifi.it>
+ */
+
+/* Data-driven RIP scenarios (formerly Second_1, Second_2 and Second_3)
+
+   A config file holds one or more scenarios. Each starts with a
+   "scenario" line; '#' starts a comment.
+
+     scenario <name>                 output goes to Routing_Table_<name>.txt
+     router <node>...                nodes running RIP
+     host <node>...                  nodes with a default route to their first link
+     link <a> <b> <delay> [<rate>]   two-node CSMA network, the n-th one /24 from 10.0.0.0
+     down <time> <a> <b>             take the a-b link down at both ends
+     up <time> <a> <b>               bring it back up
+     print <time>...                 print every router's table at these times
+     ping <src> <dst> <start> <stop> 1024 byte ping every second
+     splitHorizon <strategy>         NoSplitHorizon, SplitHorizon or PoisonReverse
+     stop <time>                     simulation end
+     observe <router>...             routers the convergence observer samples (default all)
+     topology <kind> <args> <delay> [<rate>]
+                                     generated routers and links, see rip-topology.h:
+                                     grid <rows> <cols>, random <routers> <degree>,
+                                     fattree <k> or edges <file>
+
+   After the run, the convergence time, route changes and flaps following
+   every link event are printed (see rip-convergence.h). --stableTime ends
+   a scenario once the routes have been quiet that long after the last
+   event, instead of at its stop time. On large topologies, sample only
+   the routers of interest with "observe" or --observeNodes, which
+   replaces the scenario's list.
+
+   --routeLog keeps every table difference the observer sees in a compact
+   binary log, from which RouteLog rebuilds any router's table at any time,
+   instead of print snapshots.
+
+   The full ascii trace of the original example is off unless --asciiTrace
+   is given; --capture writes filtered pcap files per device instead, and
+   with --captureRing only the frames around link events (packet-capture.h).
+
+   Each scenario ends with a line of router and link counts, setup and run
+   wall time, events/s and peak RSS, to follow RIP as topologies grow.
+
+   A scenario aborts if a ping's destination is more router hops away
+   than RIP can reach (15) before any link event.
+
+   Interfaces are numbered by link order on each node, so "down 50 RouterA
+   RouterB" finds them itself. Router interfaces facing a host are left out
+   of RIP, as in the original example.
+
+   Scenarios run one after another in this process, or with --jobs=N as N
+   worker processes at a time (each with its log in <name>.log).
+
+     ./waf --run "scratch/RipScenario --config=scratch/rip-scenarios.cfg"
+     ./waf --run "scratch/RipScenario --config=scratch/rip-scenarios.cfg --only=Second2"
+*/
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "ns3/core-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/csma-module.h"
+#include "ns3/internet-apps-module.h"
+#include "ns3/ipv4-static-routing-helper.h"
+#include "ns3/ipv4-routing-table-entry.h"
+#include "sim-profiler.h"
+#include "rip-convergence.h"
+#include "rip-topology.h"
+#include "packet-capture.h"
+
+using namespace ns3;
+using namespace std;
+
+NS_LOG_COMPONENT_DEFINE ("RipScenario");
+
+struct RipLink
+{
+  string a;
+  string b;
+  string delay;
+  string rate;
+};
+
+struct RipLinkEvent
+{
+  double time;
+  bool up;
+  string a;
+  string b;
+};
+
+struct RipPing
+{
+  string src;
+  string dst;
+  double start;
+  double stop;
+};
+
+struct RipScenarioConfig
+{
+  string name;
+  vector<string> nodes;         // in declaration order, which sets the node ids
+  vector<string> routers;
+  vector<string> hosts;
+  vector<RipLink> links;
+  vector<RipLinkEvent> events;
+  vector<double> printTimes;
+  vector<RipPing> pings;
+  vector<string> observe;       // routers the convergence observer samples, empty for all
+  string splitHorizon;
+  double stop;
+  set<string> known;            // every declared node, to catch duplicates
+};
+
+// Command line settings applied to every scenario
+struct RipRunOptions
+{
+  string linkDelay;
+  bool showPings;
+  bool asciiTrace;
+  Time sampleInterval;
+  Time stablePeriod;
+  vector<string> observeNodes;  // replaces every scenario's observe list if not empty
+  bool routeLog;
+  string capture;               // protocol filter, empty for no capture
+  set<string> captureNodes;     // empty for every node
+  uint32_t captureSnapLen;
+  uint64_t captureRingBytes;
+  Time captureAfter;
+};
+
+void TearDownLink (Ptr<Node> nodeA, Ptr<Node> nodeB, uint32_t interfaceA, uint32_t interfaceB)
+{
+  nodeA->GetObject<Ipv4> ()->SetDown (interfaceA);
+  nodeB->GetObject<Ipv4> ()->SetDown (interfaceB);
+}
+
+void MakeLink (Ptr<Node> nodeA, Ptr<Node> nodeB, uint32_t interfaceA, uint32_t interfaceB)
+{
+  nodeA->GetObject<Ipv4> ()->SetUp (interfaceA);
+  nodeB->GetObject<Ipv4> ()->SetUp (interfaceB);
+}
+
+static vector<RipScenarioConfig>
+ReadScenarios (string fileName)
+{
+  vector<RipScenarioConfig> scenarios;
+  ifstream in (fileName);
+  NS_ABORT_MSG_UNLESS (in.is_open (), "Cannot open scenario file " << fileName);
+  string line;
+  uint32_t lineNo = 0;
+  while (getline (in, line))
+    {
+      lineNo++;
+      line = line.substr (0, line.find ('#'));
+      stringstream ss (line);
+      string key;
+      if (!(ss >> key))
+        {
+          continue;
+        }
+      if (key == "scenario")
+        {
+          RipScenarioConfig s;
+          NS_ABORT_MSG_UNLESS (ss >> s.name, fileName << ":" << lineNo << ": scenario needs a name");
+          s.splitHorizon = "SplitHorizon";
+          s.stop = 600;
+          scenarios.push_back (s);
+          continue;
+        }
+      NS_ABORT_MSG_IF (scenarios.empty (), fileName << ":" << lineNo << ": " << key << " before the first scenario line");
+      RipScenarioConfig &s = scenarios.back ();
+      bool ok = true;
+      if (key == "router" || key == "host")
+        {
+          string node;
+          while (ss >> node)
+            {
+              NS_ABORT_MSG_UNLESS (s.known.insert (node).second, fileName << ":" << lineNo << ": " << node << " declared twice");
+              (key == "router" ? s.routers : s.hosts).push_back (node);
+              s.nodes.push_back (node);
+            }
+        }
+      else if (key == "topology")
+        {
+          string kind;
+          RipTopology t;
+          ss >> kind;
+          if (kind == "grid")
+            {
+              uint32_t rows, cols;
+              ok = static_cast<bool> (ss >> rows >> cols);
+              t = RipGridTopology (rows, cols);
+            }
+          else if (kind == "random")
+            {
+              uint32_t n;
+              double degree;
+              ok = static_cast<bool> (ss >> n >> degree);
+              t = RipRandomTopology (n, degree);
+            }
+          else if (kind == "fattree")
+            {
+              uint32_t k;
+              ok = static_cast<bool> (ss >> k);
+              t = RipFatTreeTopology (k);
+            }
+          else if (kind == "edges")
+            {
+              string edges;
+              ok = static_cast<bool> (ss >> edges);
+              t = RipEdgeListTopology (edges);
+            }
+          else
+            {
+              ok = false;
+            }
+          RipLink l;
+          ok = ok && static_cast<bool> (ss >> l.delay);
+          if (!(ss >> l.rate))
+            {
+              l.rate = "5Mbps";
+            }
+          // Routers may already be declared, e.g. to fix the order of the node ids
+          for (const string &r : t.routers)
+            {
+              if (s.known.insert (r).second)
+                {
+                  s.routers.push_back (r);
+                  s.nodes.push_back (r);
+                }
+            }
+          for (const pair<string, string> &link : t.links)
+            {
+              l.a = link.first;
+              l.b = link.second;
+              s.links.push_back (l);
+            }
+        }
+      else if (key == "link")
+        {
+          RipLink l;
+          ok = static_cast<bool> (ss >> l.a >> l.b >> l.delay);
+          if (!(ss >> l.rate))
+            {
+              l.rate = "5Mbps";
+            }
+          s.links.push_back (l);
+        }
+      else if (key == "down" || key == "up")
+        {
+          RipLinkEvent e;
+          e.up = key == "up";
+          ok = static_cast<bool> (ss >> e.time >> e.a >> e.b);
+          s.events.push_back (e);
+        }
+      else if (key == "print")
+        {
+          double t;
+          while (ss >> t)
+            {
+              s.printTimes.push_back (t);
+            }
+        }
+      else if (key == "ping")
+        {
+          RipPing p;
+          ok = static_cast<bool> (ss >> p.src >> p.dst >> p.start >> p.stop);
+          s.pings.push_back (p);
+        }
+      else if (key == "observe")
+        {
+          string router;
+          while (ss >> router)
+            {
+              s.observe.push_back (router);
+            }
+        }
+      else if (key == "splitHorizon")
+        {
+          ok = static_cast<bool> (ss >> s.splitHorizon);
+        }
+      else if (key == "stop")
+        {
+          ok = static_cast<bool> (ss >> s.stop);
+        }
+      else
+        {
+          ok = false;
+        }
+      NS_ABORT_MSG_UNLESS (ok, fileName << ":" << lineNo << ": bad line: " << line);
+    }
+  return scenarios;
+}
+
+// The router a ping leaves from or arrives at: the node itself, or a host's first link
+static string
+EdgeRouter (const RipScenarioConfig &s, const string &node)
+{
+  if (find (s.hosts.begin (), s.hosts.end (), node) == s.hosts.end ())
+    {
+      return node;
+    }
+  for (const RipLink &l : s.links)
+    {
+      if (l.a == node || l.b == node)
+        {
+          return l.a == node ? l.b : l.a;
+        }
+    }
+  return "";
+}
+
+// Router-to-router links between two routers before any link event, or
+// UINT32_MAX if they are not connected
+static uint32_t
+RouterHops (const RipScenarioConfig &s, const string &from, const string &to)
+{
+  set<string> hosts (s.hosts.begin (), s.hosts.end ());
+  map<string, vector<string> > neighbours;
+  for (const RipLink &l : s.links)
+    {
+      if (!hosts.count (l.a) && !hosts.count (l.b))
+        {
+          neighbours[l.a].push_back (l.b);
+          neighbours[l.b].push_back (l.a);
+        }
+    }
+  map<string, uint32_t> hops;
+  hops[from] = 0;
+  deque<string> queue (1, from);
+  while (!queue.empty () && hops.find (to) == hops.end ())
+    {
+      string node = queue.front ();
+      queue.pop_front ();
+      for (const string &next : neighbours[node])
+        {
+          if (hops.insert (make_pair (next, hops[node] + 1)).second)
+            {
+              queue.push_back (next);
+            }
+        }
+    }
+  return hops.find (to) == hops.end () ? UINT32_MAX : hops[to];
+}
+
+static void
+RunScenario (const RipScenarioConfig &s, const RipRunOptions &o)
+{
+  SimProfiler::Phase ("setup");
+  auto setupStart = chrono::steady_clock::now ();
+  cout << "Scenario " << s.name << endl;
+
+  if (s.splitHorizon == "NoSplitHorizon")
+    {
+      Config::SetDefault ("ns3::Rip::SplitHorizon", EnumValue (Rip::NO_SPLIT_HORIZON));
+    }
+  else if (s.splitHorizon == "SplitHorizon")
+    {
+      Config::SetDefault ("ns3::Rip::SplitHorizon", EnumValue (Rip::SPLIT_HORIZON));
+    }
+  else
+    {
+      Config::SetDefault ("ns3::Rip::SplitHorizon", EnumValue (Rip::POISON_REVERSE));
+    }
+
+  NS_LOG_INFO ("Create nodes.");
+  map<string, Ptr<Node> > nodes;
+  map<string, bool> isHost;
+  NodeContainer routers;
+  NodeContainer hosts;
+  for (const string &name : s.hosts)
+    {
+      isHost[name] = true;
+    }
+  for (const string &name : s.nodes)
+    {
+      Ptr<Node> node = CreateObject<Node> ();
+      Names::Add (name, node);
+      nodes[name] = node;
+      (isHost[name] ? hosts : routers).Add (node);
+    }
+
+  NS_LOG_INFO ("Create channels.");
+  // Interfaces are added in link order on each node, after the loopback (0)
+  CsmaHelper csma;
+  vector<NetDeviceContainer> devices;
+  vector<pair<uint32_t, uint32_t> > interfaces;
+  map<string, uint32_t> nInterfaces;
+  map<pair<string, string>, uint32_t> linkIndex;
+  for (const RipLink &l : s.links)
+    {
+      NS_ABORT_MSG_IF (nodes.find (l.a) == nodes.end () || nodes.find (l.b) == nodes.end (),
+                       s.name << ": link " << l.a << " " << l.b << " uses an undeclared node");
+      csma.SetChannelAttribute ("DataRate", StringValue (l.rate));
+      csma.SetChannelAttribute ("Delay", StringValue (o.linkDelay.empty () ? l.delay : o.linkDelay));
+      devices.push_back (csma.Install (NodeContainer (nodes[l.a], nodes[l.b])));
+      interfaces.push_back (make_pair (++nInterfaces[l.a], ++nInterfaces[l.b]));
+      linkIndex.insert (make_pair (make_pair (l.a, l.b), devices.size () - 1));
+    }
+
+  NS_LOG_INFO ("Create IPv4 and routing");
+  RipHelper ripRouting;
+  for (uint32_t i = 0; i < s.links.size (); i++)
+    {
+      const RipLink &l = s.links[i];
+      if (!isHost[l.a] && isHost[l.b])
+        {
+          ripRouting.ExcludeInterface (nodes[l.a], interfaces[i].first);
+        }
+      if (isHost[l.a] && !isHost[l.b])
+        {
+          ripRouting.ExcludeInterface (nodes[l.b], interfaces[i].second);
+        }
+    }
+
+  Ipv4ListRoutingHelper listRH;
+  listRH.Add (ripRouting, 0);
+
+  InternetStackHelper internet;
+  internet.SetIpv6StackInstall (false);
+  internet.SetRoutingHelper (listRH);
+  internet.Install (routers);
+
+  InternetStackHelper internetNodes;
+  internetNodes.SetIpv6StackInstall (false);
+  internetNodes.Install (hosts);
+
+  // Fixed streams from a fixed base, so a scenario draws the same numbers
+  // whether it runs alone (--only, --jobs) or after others in this process
+  int64_t stream = RIP_TOPOLOGY_STREAM + 1;
+  stream += internet.AssignStreams (routers, stream);
+  stream += internetNodes.AssignStreams (hosts, stream);
+  stream += ripRouting.AssignStreams (routers, stream);
+  for (NetDeviceContainer &ndc : devices)
+    {
+      stream += csma.AssignStreams (ndc, stream);
+    }
+
+  NS_LOG_INFO ("Assign IPv4 Addresses.");
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase (Ipv4Address ("10.0.0.0"), Ipv4Mask ("255.255.255.0"));
+  vector<Ipv4InterfaceContainer> addresses;
+  for (NetDeviceContainer &ndc : devices)
+    {
+      addresses.push_back (ipv4.Assign (ndc));
+      ipv4.NewNetwork ();
+    }
+
+  // A host reaches everything through the other end of its first link
+  map<string, Ipv4Address> hostAddress;
+  for (const string &name : s.hosts)
+    {
+      for (uint32_t i = 0; i < s.links.size (); i++)
+        {
+          const RipLink &l = s.links[i];
+          if (l.a != name && l.b != name)
+            {
+              continue;
+            }
+          bool first = l.a == name;
+          Ptr<Ipv4StaticRouting> staticRouting;
+          staticRouting = Ipv4RoutingHelper::GetRouting <Ipv4StaticRouting> (nodes[name]->GetObject<Ipv4> ()->GetRoutingProtocol ());
+          staticRouting->SetDefaultRoute (addresses[i].GetAddress (first ? 1 : 0),
+                                          first ? interfaces[i].first : interfaces[i].second);
+          hostAddress[name] = addresses[i].GetAddress (first ? 0 : 1);
+          break;
+        }
+    }
+
+  if (!s.printTimes.empty ())
+    {
+      RipHelper routingHelper;
+
+      AsciiTraceHelper asciiTraceHelper;
+      Ptr<OutputStreamWrapper> routingStream = asciiTraceHelper.CreateFileStream ("Routing_Table_" + s.name + ".txt");
+
+      for (double t : s.printTimes)
+        {
+          for (const string &name : s.routers)
+            {
+              routingHelper.PrintRoutingTableAt (Seconds (t), nodes[name], routingStream);
+            }
+        }
+    }
+
+  NS_LOG_INFO ("Create Applications.");
+  uint32_t packetSize = 1024;
+  Time interPacketInterval = Seconds (1.0);
+  for (const RipPing &p : s.pings)
+    {
+      NS_ABORT_MSG_IF (hostAddress.find (p.dst) == hostAddress.end () || nodes.find (p.src) == nodes.end (),
+                       s.name << ": ping " << p.src << " " << p.dst << " needs a linked source and host destination");
+      // The destination's network is advertised with metric 1 at its own
+      // router and one more per router hop; RIP takes 16 as unreachable
+      string srcRouter = EdgeRouter (s, p.src);
+      uint32_t hops = srcRouter.empty () ? UINT32_MAX : RouterHops (s, srcRouter, EdgeRouter (s, p.dst));
+      NS_ABORT_MSG_IF (hops == UINT32_MAX, s.name << ": no router path for ping " << p.src << " " << p.dst);
+      NS_ABORT_MSG_IF (hops + 1 >= 16, s.name << ": ping " << p.src << " " << p.dst << " crosses " << hops
+                                              << " router-to-router links, RIP reaches at most 14");
+      V4PingHelper ping (hostAddress[p.dst]);
+
+      ping.SetAttribute ("Interval", TimeValue (interPacketInterval));
+      ping.SetAttribute ("Size", UintegerValue (packetSize));
+      if (o.showPings)
+        {
+          ping.SetAttribute ("Verbose", BooleanValue (true));
+        }
+      ApplicationContainer apps = ping.Install (nodes[p.src]);
+      apps.Start (Seconds (p.start));
+      apps.Stop (Seconds (p.stop));
+    }
+
+  if (o.asciiTrace)
+    {
+      AsciiTraceHelper ascii;
+      csma.EnableAsciiAll (ascii.CreateFileStream (s.name + ".tr"));
+    }
+
+  unique_ptr<PacketCapture> capture;
+  if (!o.capture.empty ())
+    {
+      capture.reset (new PacketCapture (s.name, o.capture, o.captureSnapLen, o.captureRingBytes, o.captureAfter));
+      for (uint32_t i = 0; i < s.links.size (); i++)
+        {
+          for (uint32_t end = 0; end < 2; end++)
+            {
+              const string &name = end == 0 ? s.links[i].a : s.links[i].b;
+              if (o.captureNodes.empty () || o.captureNodes.count (name))
+                {
+                  capture->AddDevice (devices[i].Get (end));
+                }
+            }
+        }
+    }
+
+  // Sampling every table is the observer's cost; --sampleInterval=0 turns it off
+  bool observe = !o.sampleInterval.IsZero ();
+  RipConvergence convergence (o.sampleInterval, o.stablePeriod);
+  unique_ptr<RouteLogWriter> log;
+  if (o.routeLog)
+    {
+      NS_ABORT_MSG_UNLESS (observe, "The route log needs a --sampleInterval");
+      log.reset (new RouteLogWriter ("Routing_Table_" + s.name + ".rlog"));
+      convergence.SetLog (log.get ());
+    }
+  const vector<string> &observed = !o.observeNodes.empty () ? o.observeNodes
+                                  : !s.observe.empty () ? s.observe : s.routers;
+  for (uint32_t i = 0; observe && i < observed.size (); i++)
+    {
+      NS_ABORT_MSG_IF (nodes.find (observed[i]) == nodes.end () || isHost[observed[i]],
+                       s.name << ": cannot observe " << observed[i] << ", not a router");
+      convergence.AddRouter (nodes[observed[i]], observed[i]);
+    }
+
+  for (const RipLinkEvent &e : s.events)
+    {
+      auto it = linkIndex.find (make_pair (e.a, e.b));
+      bool reversed = it == linkIndex.end ();
+      if (reversed)
+        {
+          it = linkIndex.find (make_pair (e.b, e.a));
+        }
+      NS_ABORT_MSG_IF (it == linkIndex.end (), s.name << ": no link between " << e.a << " and " << e.b);
+      uint32_t interfaceA = reversed ? interfaces[it->second].second : interfaces[it->second].first;
+      uint32_t interfaceB = reversed ? interfaces[it->second].first : interfaces[it->second].second;
+      // The observer closes the previous epoch before the link changes
+      if (observe)
+        {
+          convergence.ExpectEvent (Seconds (e.time));
+          Simulator::Schedule (Seconds (e.time), &RipConvergence::NotifyEvent, &convergence,
+                               string (e.up ? "up " : "down ") + e.a + "-" + e.b);
+        }
+      if (capture)
+        {
+          Simulator::Schedule (Seconds (e.time), &PacketCapture::Trigger, capture.get ());
+        }
+      Simulator::Schedule (Seconds (e.time), e.up ? &MakeLink : &TearDownLink,
+                           nodes[e.a], nodes[e.b], interfaceA, interfaceB);
+    }
+
+  /* Now, do the actual simulation. */
+  NS_LOG_INFO ("Run Simulation.");
+  Simulator::Stop (Seconds (s.stop));
+  if (observe)
+    {
+      convergence.Start ();
+    }
+  SimProfiler::Phase ("run");
+  auto runStart = chrono::steady_clock::now ();
+  Simulator::Run ();
+  auto runEnd = chrono::steady_clock::now ();
+  SimProfiler::Phase ("report");
+  if (observe)
+    {
+      convergence.Report (cout);
+    }
+  if (capture)
+    {
+      capture->Report (cout);
+    }
+
+  // ru_maxrss is the peak of the whole process; run with --jobs for one value per scenario
+  struct rusage usage;
+  getrusage (RUSAGE_SELF, &usage);
+  double setupSeconds = chrono::duration<double> (runStart - setupStart).count ();
+  double runSeconds = chrono::duration<double> (runEnd - runStart).count ();
+  uint64_t events = Simulator::GetEventCount ();
+  cout << "Routers " << s.routers.size () << ", links " << s.links.size ()
+       << ": setup " << setupSeconds << " s, run " << runSeconds << " s, "
+       << events << " events, " << (runSeconds > 0 ? events / runSeconds : 0) << " events/s, peak RSS "
+       << usage.ru_maxrss << " kB" << endl;
+  SimProfiler::Phase ("teardown");
+  Simulator::Destroy ();
+  // The next scenario in this process reuses the names and 10.0.0.0 addresses
+  Names::Clear ();
+  Ipv4AddressGenerator::Reset ();
+}
+
+// Runs every scenario as "this program --only=<name>", jobs at a time; a
+// --profile of x.json becomes x.<name>.json for each of them
+static int
+RunWorkers (int argc, char **argv, const vector<RipScenarioConfig> &scenarios, uint32_t jobs, string profile)
+{
+  string profileBase = profile;
+  if (profileBase.size () > 5 && profileBase.compare (profileBase.size () - 5, 5, ".json") == 0)
+    {
+      profileBase.resize (profileBase.size () - 5);
+    }
+  uint32_t next = 0;
+  uint32_t running = 0;
+  int failed = 0;
+  map<pid_t, string> workers;
+  while (next < scenarios.size () || running > 0)
+    {
+      if (next < scenarios.size () && running < jobs)
+        {
+          vector<string> args (argv, argv + argc);
+          args.push_back ("--jobs=1");
+          args.push_back ("--only=" + scenarios[next].name);
+          args.push_back ("--profile=" + (profile.empty () ? string () : profileBase + "." + scenarios[next].name + ".json"));
+          vector<char *> childArgv;
+          for (string &a : args)
+            {
+              childArgv.push_back (&a[0]);
+            }
+          childArgv.push_back (0);
+          string log = scenarios[next].name + ".log";
+          pid_t pid = fork ();
+          if (pid == 0)
+            {
+              int fd = open (log.c_str (), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+              if (fd < 0 || dup2 (fd, STDOUT_FILENO) < 0)
+                {
+                  _exit (126);
+                }
+              execv ("/proc/self/exe", childArgv.data ());
+              _exit (127);
+            }
+          NS_ABORT_MSG_IF (pid < 0, "Cannot start scenario " << scenarios[next].name);
+          workers[pid] = scenarios[next].name;
+          running++;
+          next++;
+        }
+      else
+        {
+          int status;
+          pid_t pid;
+          do
+            {
+              pid = wait (&status);
+            }
+          while (pid < 0 && errno == EINTR);
+          NS_ABORT_MSG_IF (pid < 0, "Lost track of the scenario workers");
+          auto worker = workers.find (pid);
+          if (worker == workers.end ())
+            {
+              continue;
+            }
+          running--;
+          if (!WIFEXITED (status) || WEXITSTATUS (status) != 0)
+            {
+              cerr << "Scenario " << worker->second << " failed, see " << worker->second << ".log" << endl;
+              failed++;
+            }
+          workers.erase (worker);
+        }
+    }
+  cout << scenarios.size () << " scenarios, " << failed << " failed" << endl;
+  return failed > 0 ? 1 : 0;
+}
+
+int main (int argc, char **argv)
+{
+  bool verbose = false;
+  bool showPings = false;
+  bool asciiTrace = false;
+  std::string capture = "";
+  std::string captureNodes = "";
+  uint32_t captureSnapLen = 256;
+  double captureRing = 0;
+  double captureAfter = 5;
+  std::string config = "rip-scenarios.cfg";
+  std::string only = "";
+  std::string linkDelay = "";
+  uint32_t jobs = 1;
+  double sampleInterval = 0.1;
+  double stableTime = 0;
+  std::string observeNodes = "";
+  bool routeLog = false;
+  std::string profile = "";
+
+  CommandLine cmd;
+  cmd.AddValue ("config", "Scenario file", config);
+  cmd.AddValue ("only", "Run only the scenario with this name", only);
+  cmd.AddValue ("jobs", "Run the scenarios as this many worker processes at a time", jobs);
+  cmd.AddValue ("linkDelay", "Override the delay of every link, e.g. 100ms", linkDelay);
+  cmd.AddValue ("sampleInterval", "Seconds between routing table samples of the convergence observer", sampleInterval);
+  cmd.AddValue ("observeNodes", "Routers the convergence observer samples, comma separated, instead of each scenario's observe list", observeNodes);
+  cmd.AddValue ("routeLog", "Log every routing table difference to Routing_Table_<name>.rlog (see RouteLog)", routeLog);
+  cmd.AddValue ("stableTime", "Stop once no route changed for this many seconds after the last link event (0 runs to the stop time)", stableTime);
+  cmd.AddValue ("verbose", "turn on log components", verbose);
+  cmd.AddValue ("showPings", "Show Ping reception", showPings);
+  cmd.AddValue ("asciiTrace", "Write the full CSMA ascii trace of each scenario to <name>.tr", asciiTrace);
+  cmd.AddValue ("capture", "Capture these protocols to <name>-<node>-<device>.pcap: all, rip, udp, icmp, tcp, arp (comma separated)", capture);
+  cmd.AddValue ("captureNodes", "Capture only on the devices of these nodes (comma separated, empty for all)", captureNodes);
+  cmd.AddValue ("captureSnapLen", "Bytes kept of each captured frame", captureSnapLen);
+  cmd.AddValue ("captureRing", "Hold the last this many MB of captured frames and write them only at link events (0 writes all)", captureRing);
+  cmd.AddValue ("captureAfter", "Seconds written directly after each link event in ring mode", captureAfter);
+  cmd.AddValue ("profile", "Write wall time per phase, events/s and peak RSS to this JSON file (with --jobs, x.json becomes x.<name>.json per scenario)", profile);
+  cmd.Parse (argc, argv);
+
+  if (verbose)
+    {
+      LogComponentEnableAll (LogLevel (LOG_PREFIX_TIME | LOG_PREFIX_NODE));
+      LogComponentEnable ("RipScenario", LOG_LEVEL_INFO);
+      LogComponentEnable ("Rip", LOG_LEVEL_ALL);
+      LogComponentEnable ("Ipv4Interface", LOG_LEVEL_ALL);
+      LogComponentEnable ("Icmpv4L4Protocol", LOG_LEVEL_ALL);
+      LogComponentEnable ("Ipv4L3Protocol", LOG_LEVEL_ALL);
+      LogComponentEnable ("ArpCache", LOG_LEVEL_ALL);
+      LogComponentEnable ("V4Ping", LOG_LEVEL_ALL);
+    }
+
+  vector<RipScenarioConfig> scenarios = ReadScenarios (config);
+  if (!only.empty ())
+    {
+      vector<RipScenarioConfig> selected;
+      for (const RipScenarioConfig &s : scenarios)
+        {
+          if (s.name == only)
+            {
+              selected.push_back (s);
+            }
+        }
+      NS_ABORT_MSG_IF (selected.empty (), "No scenario " << only << " in " << config);
+      scenarios = selected;
+    }
+
+  if (jobs > 1 && scenarios.size () > 1)
+    {
+      return RunWorkers (argc, argv, scenarios, jobs, profile);
+    }
+
+  RipRunOptions options;
+  options.linkDelay = linkDelay;
+  options.showPings = showPings;
+  options.asciiTrace = asciiTrace;
+  options.sampleInterval = Seconds (sampleInterval);
+  options.stablePeriod = Seconds (stableTime);
+  stringstream observeList (observeNodes);
+  string router;
+  while (getline (observeList, router, ','))
+    {
+      options.observeNodes.push_back (router);
+    }
+  options.routeLog = routeLog;
+  options.capture = capture;
+  stringstream nodeList (captureNodes);
+  string node;
+  while (getline (nodeList, node, ','))
+    {
+      options.captureNodes.insert (node);
+    }
+  options.captureSnapLen = captureSnapLen;
+  options.captureRingBytes = static_cast<uint64_t> (captureRing * 1024 * 1024);
+  options.captureAfter = Seconds (captureAfter);
+
+  if (!profile.empty ())
+    {
+      SimProfiler::Enable ();
+    }
+  for (const RipScenarioConfig &s : scenarios)
+    {
+      RunScenario (s, options);
+    }
+  SimProfiler::Finish ();
+  SimProfiler::Write (profile);
+  NS_LOG_INFO ("Done.");
+  return 0;
+}
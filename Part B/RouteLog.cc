@@ -0,0 +1,103 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+  Queries the binary route log (route-log.h) that RipScenario
+  --routeLog=true writes to Routing_Table_<name>.rlog for each scenario.
+  Only the routers the convergence observer samples are logged.
+
+  RouteLog <log> routers
+      lists the routers in the log
+  RouteLog <log> table <router> <time>
+      prints the router's table as of time, in the layout of
+      Rip::PrintRoutingTable
+  RouteLog <log> history <router> [t0 t1]
+      prints every add (+), remove (-) and change (~) of the router's
+      routes between t0 and t1
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <string>
+#include "route-log.h"
+
+using namespace std;
+
+static string
+Dotted (uint32_t a)
+{
+  char text[16];
+  snprintf (text, sizeof (text), "%u.%u.%u.%u", a >> 24, (a >> 16) & 0xff, (a >> 8) & 0xff, a & 0xff);
+  return text;
+}
+
+static void
+PrintRoute (const RouteLogRecord &r)
+{
+  printf ("%-16s%-16s%-16s%-7u%u\n", Dotted (r.destination).c_str (), Dotted (r.gateway).c_str (),
+          Dotted (r.mask).c_str (), r.metric, r.interface);
+}
+
+int main (int argc, char *argv[])
+{
+  string command = argc > 2 ? argv[2] : "";
+  bool known = command == "routers" || (command == "table" && argc == 5)
+    || (command == "history" && (argc == 4 || argc == 6));
+  if (!known)
+    {
+      cerr << "Usage: " << argv[0] << " <log> routers" << endl;
+      cerr << "       " << argv[0] << " <log> table <router> <time>" << endl;
+      cerr << "       " << argv[0] << " <log> history <router> [t0 t1]" << endl;
+      return 1;
+    }
+
+  RouteLogReader reader;
+  string error = reader.Open (argv[1]);
+  if (!error.empty ())
+    {
+      cerr << error << endl;
+      return 1;
+    }
+
+  if (command == "routers")
+    {
+      for (uint32_t i = 0; i < reader.RouterCount (); i++)
+        {
+          cout << reader.RouterName (i) << "\n";
+        }
+      return 0;
+    }
+
+  uint32_t router = reader.FindRouter (argv[3]);
+  if (router == reader.RouterCount ())
+    {
+      cerr << "No router " << argv[3] << " in " << argv[1] << endl;
+      return 1;
+    }
+
+  if (command == "table")
+    {
+      double time = atof (argv[4]);
+      printf ("%s at %g s\n", argv[3], time);
+      printf ("Destination     Gateway         Genmask         Metric Iface\n");
+      for (const auto &entry : reader.TableAt (router, time))
+        {
+          PrintRoute (entry.second);
+        }
+      return 0;
+    }
+
+  double t0 = argc > 4 ? atof (argv[4]) : 0;
+  double t1 = argc > 5 ? atof (argv[5]) : numeric_limits<double>::max ();
+  static const char ops[] = {'+', '-', '~'};
+  for (const RouteLogRecord &r : reader.Records ())
+    {
+      if (r.router != router || r.time < t0 || r.time > t1)
+        {
+          continue;
+        }
+      printf ("%-10g %c ", r.time, r.op < 3 ? ops[r.op] : '?');
+      PrintRoute (r);
+    }
+  return 0;
+}
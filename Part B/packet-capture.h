@@ -0,0 +1,219 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef PACKET_CAPTURE_H
+#define PACKET_CAPTURE_H
+
+/*
+  Filtered, bounded packet capture for RipScenario, in place of
+  csma.EnableAsciiAll.
+
+  Frames seen by the "Sniffer" trace of the selected CSMA devices pass a
+  protocol filter (any of all, rip = UDP port 520, udp, icmp, tcp, arp) and
+  go to one pcap file per device, <prefix>-<node>-<device>.pcap, cut to the
+  snap length.
+
+  In ring mode matching frames are held in memory instead, the oldest
+  dropped beyond the byte budget. Trigger () (a link going down or up)
+  writes the held frames, i.e. the run up to the event, and keeps writing
+  directly for the following seconds; everything else is never written.
+  The ring keeps only the first snap length bytes of each frame, so their
+  pcap records give that as the original length too.
+*/
+
+#include <algorithm>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+
+class PacketCapture
+{
+public:
+  // filter is a comma separated list of protocols; ringBytes 0 writes every match
+  PacketCapture (std::string prefix, std::string filter, uint32_t snapLen,
+                 uint64_t ringBytes, ns3::Time after);
+
+  void AddDevice (ns3::Ptr<ns3::NetDevice> device);
+
+  // Writes the ring and captures directly for the next "after" seconds
+  void Trigger (void);
+
+  void Report (std::ostream &os);
+
+private:
+  struct Held
+  {
+    ns3::Time time;
+    uint32_t device;
+    ns3::Ptr<const ns3::Packet> packet;
+  };
+
+  static void Sniff (PacketCapture *capture, uint32_t device, ns3::Ptr<const ns3::Packet> packet);
+
+  bool Match (ns3::Ptr<const ns3::Packet> packet) const;
+  void Write (ns3::Time time, uint32_t device, ns3::Ptr<const ns3::Packet> packet);
+
+  std::string m_prefix;
+  std::set<std::string> m_protocols;
+  uint32_t m_snapLen;
+  uint64_t m_ringBytes;
+  ns3::Time m_after;
+  ns3::Time m_liveUntil;
+  std::vector<std::string> m_names;
+  std::vector<ns3::Ptr<ns3::PcapFileWrapper> > m_files;   // opened on the first write
+  std::deque<Held> m_ring;
+  uint64_t m_held;
+  uint64_t m_matched;
+  uint64_t m_written;
+  uint64_t m_writtenBytes;
+};
+
+inline
+PacketCapture::PacketCapture (std::string prefix, std::string filter, uint32_t snapLen,
+                              uint64_t ringBytes, ns3::Time after)
+  : m_prefix (prefix),
+    m_snapLen (snapLen),
+    m_ringBytes (ringBytes),
+    m_after (after),
+    m_liveUntil (ns3::Seconds (-1)),
+    m_held (0),
+    m_matched (0),
+    m_written (0),
+    m_writtenBytes (0)
+{
+  std::stringstream ss (filter);
+  std::string protocol;
+  while (std::getline (ss, protocol, ','))
+    {
+      NS_ABORT_MSG_UNLESS (protocol == "all" || protocol == "rip" || protocol == "udp" || protocol == "icmp"
+                           || protocol == "tcp" || protocol == "arp", "Unknown capture protocol " << protocol);
+      m_protocols.insert (protocol);
+    }
+}
+
+inline void
+PacketCapture::AddDevice (ns3::Ptr<ns3::NetDevice> device)
+{
+  ns3::Ptr<ns3::Node> node = device->GetNode ();
+  std::string name = ns3::Names::FindName (node);
+  if (name.empty ())
+    {
+      name = std::to_string (node->GetId ());
+    }
+  m_names.push_back (name + "-" + std::to_string (device->GetIfIndex ()));
+  m_files.push_back (0);
+  device->TraceConnectWithoutContext ("Sniffer", ns3::MakeBoundCallback (&PacketCapture::Sniff, this,
+                                                                         static_cast<uint32_t> (m_names.size () - 1)));
+}
+
+inline void
+PacketCapture::Sniff (PacketCapture *capture, uint32_t device, ns3::Ptr<const ns3::Packet> packet)
+{
+  if (!capture->Match (packet))
+    {
+      return;
+    }
+  capture->m_matched++;
+  ns3::Time now = ns3::Simulator::Now ();
+  if (capture->m_ringBytes == 0 || now <= capture->m_liveUntil)
+    {
+      capture->Write (now, device, packet);
+      return;
+    }
+  // Only the snap length is kept, so the ring holds what its budget counts
+  uint32_t length = std::min (packet->GetSize (), capture->m_snapLen);
+  capture->m_ring.push_back (Held {now, device, packet->CreateFragment (0, length)});
+  capture->m_held += length;
+  while (capture->m_held > capture->m_ringBytes)
+    {
+      capture->m_held -= capture->m_ring.front ().packet->GetSize ();
+      capture->m_ring.pop_front ();
+    }
+}
+
+// CSMA frames carry an Ethernet (DIX) header in front of the IP packet
+inline bool
+PacketCapture::Match (ns3::Ptr<const ns3::Packet> packet) const
+{
+  if (m_protocols.count ("all"))
+    {
+      return true;
+    }
+  ns3::Ptr<ns3::Packet> copy = packet->Copy ();
+  ns3::EthernetHeader ethernet;
+  copy->RemoveHeader (ethernet);
+  if (ethernet.GetLengthType () == 0x0806)
+    {
+      return m_protocols.count ("arp") > 0;
+    }
+  if (ethernet.GetLengthType () != 0x0800)
+    {
+      return false;
+    }
+  ns3::Ipv4Header ip;
+  copy->RemoveHeader (ip);
+  switch (ip.GetProtocol ())
+    {
+    case 1:
+      return m_protocols.count ("icmp") > 0;
+    case 6:
+      return m_protocols.count ("tcp") > 0;
+    case 17:
+      {
+        if (m_protocols.count ("udp"))
+          {
+            return true;
+          }
+        ns3::UdpHeader udp;
+        copy->PeekHeader (udp);
+        return m_protocols.count ("rip") > 0 && (udp.GetSourcePort () == 520 || udp.GetDestinationPort () == 520);
+      }
+    default:
+      return false;
+    }
+}
+
+inline void
+PacketCapture::Write (ns3::Time time, uint32_t device, ns3::Ptr<const ns3::Packet> packet)
+{
+  if (!m_files[device])
+    {
+      ns3::PcapHelper pcapHelper;
+      m_files[device] = pcapHelper.CreateFile (m_prefix + "-" + m_names[device] + ".pcap", std::ios::out,
+                                               ns3::PcapHelper::DLT_EN10MB, m_snapLen);
+    }
+  m_files[device]->Write (time, packet);
+  m_written++;
+  m_writtenBytes += std::min (packet->GetSize (), m_snapLen);
+}
+
+inline void
+PacketCapture::Trigger (void)
+{
+  for (const Held &h : m_ring)
+    {
+      Write (h.time, h.device, h.packet);
+    }
+  m_ring.clear ();
+  m_held = 0;
+  m_liveUntil = ns3::Simulator::Now () + m_after;
+}
+
+inline void
+PacketCapture::Report (std::ostream &os)
+{
+  os << "Capture: " << m_matched << " packets matched, " << m_written << " written ("
+     << m_writtenBytes << " bytes)";
+  if (m_ringBytes > 0)
+    {
+      os << ", " << m_ring.size () << " left in the ring";
+    }
+  os << std::endl;
+}
+
+#endif // PACKET_CAPTURE_H
@@ -0,0 +1,262 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef RIP_CONVERGENCE_H
+#define RIP_CONVERGENCE_H
+
+/*
+  Convergence observer for RipScenario.
+
+  Rip has no trace source for table changes, so every --sampleInterval the
+  observer reads each router's valid routes (destination/mask -> gateway,
+  metric, interface) and compares them with the previous sample. Every
+  difference is a route change at that router for that destination.
+  A sample prints and parses every table it reads, so on large topologies
+  add only the routers of interest; convergence is seen at them alone and
+  only to within one interval, as the report says.
+
+  Link events split the run into epochs (the first one starts at 0). For
+  each epoch Report () gives the time from the event to the last route
+  change in it, the number of changes, and the flaps: changes beyond the
+  first of a (router, destination) pair within the epoch.
+
+  With a stable period set, the simulation stops once no route changed for
+  that long and no link event is still to come.
+
+  With a RouteLogWriter attached, the first sample of each router and every
+  later difference are also written to the binary route log (route-log.h).
+*/
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "ns3/core-module.h"
+#include "ns3/internet-module.h"
+#include "route-log.h"
+
+class RipConvergence
+{
+public:
+  RipConvergence (ns3::Time interval, ns3::Time stablePeriod);
+
+  void AddRouter (ns3::Ptr<ns3::Node> node, std::string name);
+
+  // Also writes every table difference to log, which must outlive the run
+  void SetLog (RouteLogWriter *log);
+
+  // Tells the observer a link event will happen at time, so it does not stop before
+  void ExpectEvent (ns3::Time time);
+
+  // Starts a new epoch; schedule it just before the link change itself
+  void NotifyEvent (std::string description);
+
+  void Start (void);
+
+  void Report (std::ostream &os);
+
+private:
+  struct Route
+  {
+    uint32_t gateway;
+    uint32_t metric;
+    std::string interface;      // index, or device name if it has one
+
+    bool operator== (const Route &o) const
+    {
+      return gateway == o.gateway && metric == o.metric && interface == o.interface;
+    }
+  };
+
+  typedef std::pair<uint32_t, uint32_t> Destination;   // network, mask
+
+  struct Epoch
+  {
+    std::string description;
+    ns3::Time start;
+    ns3::Time lastChange;      // start while nothing changed
+    uint32_t changes;
+    std::set<std::pair<uint32_t, Destination> > changed;
+  };
+
+  typedef std::map<Destination, Route> Table;
+
+  Table Read (uint32_t router);
+  void Sample (void);
+  void Poll (void);
+
+  ns3::Time m_interval;
+  ns3::Time m_stablePeriod;
+  ns3::Time m_lastExpected;
+  std::vector<ns3::Ptr<ns3::Rip> > m_rips;
+  std::vector<std::string> m_names;
+  std::vector<Table> m_tables;
+  std::vector<uint32_t> m_logIds;
+  std::vector<Epoch> m_epochs;
+  RouteLogWriter *m_log;
+};
+
+inline
+RipConvergence::RipConvergence (ns3::Time interval, ns3::Time stablePeriod)
+  : m_interval (interval),
+    m_stablePeriod (stablePeriod),
+    m_lastExpected (ns3::Seconds (0)),
+    m_log (0)
+{
+  m_epochs.push_back (Epoch {"start", ns3::Seconds (0), ns3::Seconds (0), 0, {}});
+}
+
+inline void
+RipConvergence::AddRouter (ns3::Ptr<ns3::Node> node, std::string name)
+{
+  ns3::Ptr<ns3::Ipv4> ipv4 = node->GetObject<ns3::Ipv4> ();
+  ns3::Ptr<ns3::Rip> rip = ns3::Ipv4RoutingHelper::GetRouting<ns3::Rip> (ipv4->GetRoutingProtocol ());
+  NS_ABORT_MSG_UNLESS (rip, "Router " << name << " does not run RIP");
+  m_rips.push_back (rip);
+  m_names.push_back (name);
+  m_tables.push_back (Table ());
+  m_logIds.push_back (m_log ? m_log->AddRouter (name) : 0);
+}
+
+inline void
+RipConvergence::SetLog (RouteLogWriter *log)
+{
+  NS_ABORT_MSG_UNLESS (m_rips.empty (), "Set the route log before adding routers");
+  m_log = log;
+}
+
+inline void
+RipConvergence::ExpectEvent (ns3::Time time)
+{
+  m_lastExpected = std::max (m_lastExpected, time);
+}
+
+inline void
+RipConvergence::NotifyEvent (std::string description)
+{
+  // Changes up to now belong to the previous epoch
+  Sample ();
+  ns3::Time now = ns3::Simulator::Now ();
+  m_epochs.push_back (Epoch {description, now, now, 0, {}});
+}
+
+inline void
+RipConvergence::Start (void)
+{
+  ns3::Simulator::Schedule (m_interval, &RipConvergence::Poll, this);
+}
+
+// Parses the valid routes out of Rip::PrintRoutingTable:
+// Destination Gateway Genmask Flags Metric Ref Use Iface
+inline RipConvergence::Table
+RipConvergence::Read (uint32_t router)
+{
+  std::ostringstream text;
+  ns3::Ptr<ns3::OutputStreamWrapper> stream = ns3::Create<ns3::OutputStreamWrapper> (&text);
+  m_rips[router]->PrintRoutingTable (stream);
+
+  Table table;
+  std::istringstream in (text.str ());
+  std::string line;
+  while (std::getline (in, line))
+    {
+      if (line.empty () || line[0] < '0' || line[0] > '9')
+        {
+          continue;
+        }
+      std::istringstream ls (line);
+      std::string destination, gateway, mask, flags, ref, use;
+      Route r;
+      if (ls >> destination >> gateway >> mask >> flags >> r.metric >> ref >> use >> r.interface)
+        {
+          r.gateway = ns3::Ipv4Address (gateway.c_str ()).Get ();
+          table[Destination (ns3::Ipv4Address (destination.c_str ()).Get (), ns3::Ipv4Mask (mask.c_str ()).Get ())] = r;
+        }
+    }
+  return table;
+}
+
+inline void
+RipConvergence::Sample (void)
+{
+  ns3::Time now = ns3::Simulator::Now ();
+  Epoch &epoch = m_epochs.back ();
+  for (uint32_t i = 0; i < m_rips.size (); i++)
+    {
+      Table table = Read (i);
+      Table &old = m_tables[i];
+      std::set<Destination> destinations;
+      for (const auto &entry : table)
+        {
+          destinations.insert (entry.first);
+        }
+      for (const auto &entry : old)
+        {
+          destinations.insert (entry.first);
+        }
+      for (const Destination &d : destinations)
+        {
+          auto a = old.find (d);
+          auto b = table.find (d);
+          if (a != old.end () && b != table.end () && a->second == b->second)
+            {
+              continue;
+            }
+          epoch.changes++;
+          epoch.changed.insert (std::make_pair (i, d));
+          epoch.lastChange = now;
+          if (m_log)
+            {
+              uint8_t op = a == old.end () ? ROUTE_ADD : b == table.end () ? ROUTE_REMOVE : ROUTE_CHANGE;
+              const Route &r = b == table.end () ? a->second : b->second;
+              m_log->Append (now.GetSeconds (), m_logIds[i], op, d.first, d.second, r.gateway,
+                             std::strtoul (r.interface.c_str (), 0, 10), r.metric);
+            }
+        }
+      old.swap (table);
+    }
+}
+
+inline void
+RipConvergence::Poll (void)
+{
+  Sample ();
+  ns3::Time now = ns3::Simulator::Now ();
+  if (!m_stablePeriod.IsZero () && now > m_lastExpected
+      && now - m_epochs.back ().lastChange >= m_stablePeriod)
+    {
+      std::cout << "Stable for " << m_stablePeriod.GetSeconds () << " s, stopping at "
+                << now.GetSeconds () << " s" << std::endl;
+      ns3::Simulator::Stop ();
+      return;
+    }
+  ns3::Simulator::Schedule (m_interval, &RipConvergence::Poll, this);
+}
+
+inline void
+RipConvergence::Report (std::ostream &os)
+{
+  Sample ();
+  ns3::Time now = ns3::Simulator::Now ();
+  for (const Epoch &e : m_epochs)
+    {
+      os << "Event " << e.description << " at " << e.start.GetSeconds () << " s: ";
+      if (e.changes == 0)
+        {
+          os << "no route changes" << std::endl;
+          continue;
+        }
+      os << "converged after " << (e.lastChange - e.start).GetSeconds () << " s (sampled every "
+         << m_interval.GetSeconds () << " s at " << m_rips.size () << " routers), "
+         << e.changes << " route changes, " << e.changes - e.changed.size () << " flaps";
+      if (&e == &m_epochs.back () && now - e.lastChange < m_stablePeriod)
+        {
+          os << " (still changing at the end of the run)";
+        }
+      os << std::endl;
+    }
+}
+
+#endif // RIP_CONVERGENCE_H
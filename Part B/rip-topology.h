@@ -0,0 +1,156 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef RIP_TOPOLOGY_H
+#define RIP_TOPOLOGY_H
+
+/*
+  Router topologies for RipScenario's "topology" line. A generator only
+  names routers and the links between them; RipScenario adds the hosts,
+  addresses, interface numbers, RIP exclusions and default routes.
+
+    grid <rows> <cols>        R<r>_<c>, each linked to its right and lower neighbour
+    random <routers> <degree> R<i>, a random spanning tree plus random links up
+                              to the mean degree (ns-3 RNG, so --RngRun varies it)
+    fattree <k>               k-ary fat tree of switches: C<i> core,
+                              A<pod>_<i> aggregation, E<pod>_<i> edge
+    edges <file>              one "a b" link per line, '#' starts a comment
+*/
+
+#include <algorithm>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "ns3/core-module.h"
+
+// Stream of the random topology; RipScenario numbers its own from the next one
+static const int64_t RIP_TOPOLOGY_STREAM = 0;
+
+struct RipTopology
+{
+  std::vector<std::string> routers;
+  std::vector<std::pair<std::string, std::string> > links;
+};
+
+inline RipTopology
+RipGridTopology (uint32_t rows, uint32_t cols)
+{
+  RipTopology t;
+  auto name = [] (uint32_t r, uint32_t c) { return "R" + std::to_string (r) + "_" + std::to_string (c); };
+  for (uint32_t r = 0; r < rows; r++)
+    {
+      for (uint32_t c = 0; c < cols; c++)
+        {
+          t.routers.push_back (name (r, c));
+          if (c > 0)
+            {
+              t.links.push_back (std::make_pair (name (r, c - 1), name (r, c)));
+            }
+          if (r > 0)
+            {
+              t.links.push_back (std::make_pair (name (r - 1, c), name (r, c)));
+            }
+        }
+    }
+  return t;
+}
+
+inline RipTopology
+RipRandomTopology (uint32_t n, double degree)
+{
+  RipTopology t;
+  // A fixed stream, so the graph does not depend on what was generated before it
+  ns3::Ptr<ns3::UniformRandomVariable> rng = ns3::CreateObject<ns3::UniformRandomVariable> ();
+  rng->SetStream (RIP_TOPOLOGY_STREAM);
+  std::set<std::pair<uint32_t, uint32_t> > linked;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      t.routers.push_back ("R" + std::to_string (i));
+      // Joining a random earlier router keeps the graph connected
+      if (i > 0)
+        {
+          uint32_t j = rng->GetInteger (0, i - 1);
+          linked.insert (std::make_pair (j, i));
+          t.links.push_back (std::make_pair (t.routers[j], t.routers[i]));
+        }
+    }
+  uint64_t target = static_cast<uint64_t> (n * degree / 2);
+  uint64_t maxLinks = static_cast<uint64_t> (n) * (n - 1) / 2;
+  while (n > 1 && t.links.size () < std::min (target, maxLinks))
+    {
+      uint32_t a = rng->GetInteger (0, n - 1);
+      uint32_t b = rng->GetInteger (0, n - 1);
+      if (a == b || !linked.insert (std::make_pair (std::min (a, b), std::max (a, b))).second)
+        {
+          continue;
+        }
+      t.links.push_back (std::make_pair (t.routers[a], t.routers[b]));
+    }
+  return t;
+}
+
+inline RipTopology
+RipFatTreeTopology (uint32_t k)
+{
+  NS_ABORT_MSG_UNLESS (k >= 2 && k % 2 == 0, "A fat tree needs an even k");
+  RipTopology t;
+  uint32_t half = k / 2;
+  for (uint32_t c = 0; c < half * half; c++)
+    {
+      t.routers.push_back ("C" + std::to_string (c));
+    }
+  for (uint32_t p = 0; p < k; p++)
+    {
+      std::string pod = std::to_string (p) + "_";
+      for (uint32_t i = 0; i < half; i++)
+        {
+          t.routers.push_back ("A" + pod + std::to_string (i));
+          t.routers.push_back ("E" + pod + std::to_string (i));
+        }
+      for (uint32_t a = 0; a < half; a++)
+        {
+          // Aggregation switch a of every pod reaches the same block of cores
+          for (uint32_t c = a * half; c < (a + 1) * half; c++)
+            {
+              t.links.push_back (std::make_pair ("C" + std::to_string (c), "A" + pod + std::to_string (a)));
+            }
+          for (uint32_t e = 0; e < half; e++)
+            {
+              t.links.push_back (std::make_pair ("A" + pod + std::to_string (a), "E" + pod + std::to_string (e)));
+            }
+        }
+    }
+  return t;
+}
+
+inline RipTopology
+RipEdgeListTopology (std::string fileName)
+{
+  RipTopology t;
+  std::ifstream in (fileName);
+  NS_ABORT_MSG_UNLESS (in.is_open (), "Cannot open edge list " << fileName);
+  std::set<std::string> seen;
+  std::string line;
+  while (std::getline (in, line))
+    {
+      std::stringstream ss (line.substr (0, line.find ('#')));
+      std::string a, b;
+      if (!(ss >> a))
+        {
+          continue;
+        }
+      NS_ABORT_MSG_UNLESS (ss >> b, "Bad edge in " << fileName << ": " << line);
+      for (const std::string &r : {a, b})
+        {
+          if (seen.insert (r).second)
+            {
+              t.routers.push_back (r);
+            }
+        }
+      t.links.push_back (std::make_pair (a, b));
+    }
+  return t;
+}
+
+#endif // RIP_TOPOLOGY_H
@@ -0,0 +1,274 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef ROUTE_LOG_H
+#define ROUTE_LOG_H
+
+/*
+  Binary routing table log shared by RipScenario (writer, through the
+  convergence observer) and RouteLog (reader).
+
+  The first records of a router are its whole table at the first sample,
+  as additions; after that only differences are written: a route added,
+  removed, or changed (gateway, metric or interface). Replaying the records
+  of a router up to a time gives its table at that time.
+
+  File layout:
+    RouteLogHeader
+    RouteLogRecord * n          in time order
+    router names, each as uint32_t length + bytes
+    RouteLogFooter
+*/
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+static const uint32_t ROUTE_LOG_MAGIC = 0x474c5452;   // "RTLG"
+static const uint32_t ROUTE_LOG_VERSION = 1;
+
+enum RouteLogOp
+{
+  ROUTE_ADD,
+  ROUTE_REMOVE,
+  ROUTE_CHANGE
+};
+
+struct RouteLogHeader
+{
+  uint32_t magic;
+  uint32_t version;
+  uint32_t recordSize;
+  uint32_t reserved;
+};
+
+struct RouteLogRecord
+{
+  double time;                  // seconds
+  uint32_t router;              // index into the router names
+  uint32_t destination;         // IPv4 network, host order
+  uint32_t mask;
+  uint32_t gateway;
+  uint32_t interface;
+  uint8_t metric;
+  uint8_t op;                   // RouteLogOp
+  uint8_t pad[2];
+};
+
+struct RouteLogFooter
+{
+  uint64_t namesOffset;
+  uint32_t nRouters;
+  uint32_t magic;
+};
+
+// Buffers RouteLogRecords and writes them out in blocks
+class RouteLogWriter
+{
+public:
+  RouteLogWriter (std::string fileName, size_t bufferRecords = 1 << 14);
+  ~RouteLogWriter ();
+
+  // Registers a router and returns its id
+  uint32_t AddRouter (std::string name);
+
+  void Append (double time, uint32_t router, uint8_t op, uint32_t destination, uint32_t mask,
+               uint32_t gateway, uint32_t interface, uint32_t metric);
+
+  // Flushes the buffer and writes the names; called by the destructor
+  void Close (void);
+
+private:
+  void Flush (void);
+
+  std::FILE *m_file;
+  std::vector<RouteLogRecord> m_buffer;
+  size_t m_used;
+  uint64_t m_offset;
+  std::vector<std::string> m_names;
+};
+
+inline
+RouteLogWriter::RouteLogWriter (std::string fileName, size_t bufferRecords)
+  : m_file (std::fopen (fileName.c_str (), "wb")),
+    m_buffer (bufferRecords),
+    m_used (0),
+    m_offset (sizeof (RouteLogHeader))
+{
+  if (m_file)
+    {
+      RouteLogHeader header = {ROUTE_LOG_MAGIC, ROUTE_LOG_VERSION, sizeof (RouteLogRecord), 0};
+      std::fwrite (&header, sizeof (header), 1, m_file);
+    }
+}
+
+inline
+RouteLogWriter::~RouteLogWriter ()
+{
+  Close ();
+}
+
+inline uint32_t
+RouteLogWriter::AddRouter (std::string name)
+{
+  m_names.push_back (name);
+  return m_names.size () - 1;
+}
+
+inline void
+RouteLogWriter::Append (double time, uint32_t router, uint8_t op, uint32_t destination, uint32_t mask,
+                        uint32_t gateway, uint32_t interface, uint32_t metric)
+{
+  RouteLogRecord &r = m_buffer[m_used];
+  r = RouteLogRecord {time, router, destination, mask, gateway, interface,
+                      static_cast<uint8_t> (std::min (metric, 255u)), op, {0, 0}};
+  if (++m_used == m_buffer.size ())
+    {
+      Flush ();
+    }
+}
+
+inline void
+RouteLogWriter::Flush (void)
+{
+  if (m_file && m_used > 0)
+    {
+      std::fwrite (m_buffer.data (), sizeof (RouteLogRecord), m_used, m_file);
+      m_offset += m_used * sizeof (RouteLogRecord);
+    }
+  m_used = 0;
+}
+
+inline void
+RouteLogWriter::Close (void)
+{
+  if (!m_file)
+    {
+      return;
+    }
+  Flush ();
+  for (const std::string &name : m_names)
+    {
+      uint32_t length = name.size ();
+      std::fwrite (&length, sizeof (length), 1, m_file);
+      std::fwrite (name.data (), 1, length, m_file);
+    }
+  RouteLogFooter footer = {m_offset, static_cast<uint32_t> (m_names.size ()), ROUTE_LOG_MAGIC};
+  std::fwrite (&footer, sizeof (footer), 1, m_file);
+  std::fclose (m_file);
+  m_file = 0;
+}
+
+// Loads a route log and replays it
+class RouteLogReader
+{
+public:
+  // Returns an error message, or an empty string once the log is loaded
+  std::string Open (std::string fileName);
+
+  uint32_t RouterCount (void) const;
+  std::string RouterName (uint32_t router) const;
+  // Returns the router id, or RouterCount () if there is no such router
+  uint32_t FindRouter (std::string name) const;
+
+  const std::vector<RouteLogRecord> &Records (void) const;
+
+  // (destination, mask) -> the last add/change record for it
+  typedef std::map<std::pair<uint32_t, uint32_t>, RouteLogRecord> Table;
+  // The table of router as of time, from all its records up to and including time
+  Table TableAt (uint32_t router, double time) const;
+
+private:
+  std::vector<RouteLogRecord> m_records;
+  std::vector<std::string> m_names;
+};
+
+inline std::string
+RouteLogReader::Open (std::string fileName)
+{
+  std::FILE *f = std::fopen (fileName.c_str (), "rb");
+  if (!f)
+    {
+      return "Cannot open " + fileName;
+    }
+  RouteLogHeader header;
+  RouteLogFooter footer;
+  bool ok = std::fread (&header, sizeof (header), 1, f) == 1
+    && header.magic == ROUTE_LOG_MAGIC && header.recordSize == sizeof (RouteLogRecord)
+    && std::fseek (f, -static_cast<long> (sizeof (footer)), SEEK_END) == 0
+    && std::fread (&footer, sizeof (footer), 1, f) == 1 && footer.magic == ROUTE_LOG_MAGIC;
+  if (!ok)
+    {
+      std::fclose (f);
+      return fileName + " is not a complete route log";
+    }
+  m_records.resize ((footer.namesOffset - sizeof (header)) / sizeof (RouteLogRecord));
+  std::fseek (f, sizeof (header), SEEK_SET);
+  ok = std::fread (m_records.data (), sizeof (RouteLogRecord), m_records.size (), f) == m_records.size ();
+  m_names.clear ();
+  for (uint32_t i = 0; ok && i < footer.nRouters; i++)
+    {
+      uint32_t length;
+      ok = std::fread (&length, sizeof (length), 1, f) == 1;
+      std::string name (length, '\0');
+      ok = ok && std::fread (&name[0], 1, length, f) == length;
+      m_names.push_back (name);
+    }
+  std::fclose (f);
+  return ok ? "" : fileName + " is truncated";
+}
+
+inline uint32_t
+RouteLogReader::RouterCount (void) const
+{
+  return m_names.size ();
+}
+
+inline std::string
+RouteLogReader::RouterName (uint32_t router) const
+{
+  return m_names[router];
+}
+
+inline uint32_t
+RouteLogReader::FindRouter (std::string name) const
+{
+  return std::find (m_names.begin (), m_names.end (), name) - m_names.begin ();
+}
+
+inline const std::vector<RouteLogRecord> &
+RouteLogReader::Records (void) const
+{
+  return m_records;
+}
+
+inline RouteLogReader::Table
+RouteLogReader::TableAt (uint32_t router, double time) const
+{
+  Table table;
+  for (const RouteLogRecord &r : m_records)
+    {
+      if (r.time > time)
+        {
+          break;
+        }
+      if (r.router != router)
+        {
+          continue;
+        }
+      std::pair<uint32_t, uint32_t> key (r.destination, r.mask);
+      if (r.op == ROUTE_REMOVE)
+        {
+          table.erase (key);
+        }
+      else
+        {
+          table[key] = r;
+        }
+    }
+  return table;
+}
+
+#endif // ROUTE_LOG_H
@@ -1,8 +1,20 @@
-./waf --run "scratch/Second_1 --delay=100" 
-./waf --run "scratch/Second_1 --delay=1000" 
-./waf --run "scratch/Second_1 --delay=20000" 
-./waf --run "scratch/Second_1 --delay=80000" 
+# Run from the ns-3 root after copying the files of Part B and of Common
+# (sim-profiler.h, Sweep.cc, shared with the other part) into scratch/
 
-./waf --run scratch/Second_2
+./waf --run "scratch/RipScenario --config=scratch/rip-scenarios.cfg --jobs=1"
 
-./waf --run scratch/Second_3 
\ No newline at end of file
+./waf --run "scratch/RipScenario --config=scratch/rip-scenarios.cfg --jobs=6"
+
+./waf --run "scratch/RipScenario --config=scratch/rip-scenarios.cfg --only=Second2"
+
+./waf --run "scratch/Sweep --program=build/scratch/RipScenario --out=sweepB --arg=--config=$PWD/scratch/rip-scenarios.cfg --arg=--only=Second1_100 --grid=linkDelay=100ms,1000ms,20000ms,80000ms"
+
+./waf --run "scratch/RipScenario --config=scratch/rip-scenarios.cfg --only=Second3 --stableTime=200"
+
+./waf --run "scratch/RipScenario --config=scratch/rip-scale.cfg --jobs=4 --sampleInterval=1 --stableTime=200"
+
+./waf --run "scratch/RipScenario --config=scratch/rip-scenarios.cfg --only=Second3 --routeLog=true"
+./waf --run "scratch/RouteLog Routing_Table_Second3.rlog table RouterA 70"
+./waf --run "scratch/RouteLog Routing_Table_Second3.rlog history RouterA 50 180"
+
+./waf --run "scratch/RipScenario --config=scratch/rip-scenarios.cfg --only=Second2 --capture=rip --captureRing=4 --captureAfter=10"